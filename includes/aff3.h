@@ -16,35 +16,69 @@ typedef struct Aff3 {
 // `Aff3Identity` returns an identity matrix.
 //
 // This is defined as: `[[1, 0, 0], [0, 1, 0], [0, 0, 1]]`.
-Aff3 Aff3Identity();
+MATH_API Aff3 Aff3Identity();
 
 // `Aff3Concat` applies the transformations from `aff3` onto `this` matrix.
 //
 // The order of matrices you concatenate matters. For example, concatenating a
 // rotation matrix to a translation matrix may have different results than
 // concatenating those same translation and a rotation matrix.
-Aff3 Aff3Concat(Aff3 this, Aff3 aff3);
+MATH_API Aff3 Aff3Concat(Aff3 this, Aff3 aff3);
 
 // `Aff3Invert` reverses the transformations applied from `this` matrix.
 //
 // Objects transformed by the original matrix will revert back to their original
-// transformations when you apply this transformation.
-Aff3 Aff3Invert(Aff3 this);
+// transformations when you apply this transformation. A matrix that flattens
+// everything onto a line or a point can't be inverted, so only its
+// translation is reversed.
+MATH_API Aff3 Aff3Invert(Aff3 this);
 
-Aff3 Aff3Rotate(Aff3 this, float32 angle);
+// `Aff3Rotate` rotates by `angle` in degrees around (0, 0) after `this`
+// matrix's transformations.
+MATH_API Aff3 Aff3Rotate(Aff3 this, float32 angle);
 
-Aff3 Aff3Scale(Aff3 this, float32 x, float32 y);
+// `Aff3Scale` scales by `x` and `y` from (0, 0) after `this` matrix's
+// transformations.
+MATH_API Aff3 Aff3Scale(Aff3 this, float32 x, float32 y);
 
-Aff3 Aff3Translate(Aff3 this, float32 x, float32 y);
+// `Aff3Translate` moves by `x` and `y` after `this` matrix's transformations.
+MATH_API Aff3 Aff3Translate(Aff3 this, float32 x, float32 y);
 
 // `Aff3TransformVec2` applies the matrix's transformations to the `Vec2`.
 //
 // This applies all transformations applied to this matrix onto that `Vec2`.
-Vec2 Aff3TransformVec2(Aff3 this, Vec2 vec);
+MATH_API Vec2 Aff3TransformVec2(Aff3 this, Vec2 vec);
+
+// `Aff3TransformVec2Array` applies the matrix's transformations to `count`
+// points, writing them to `out`. `out` may be `points` to transform them in
+// place.
+//
+// This and the other array functions below use AVX2 or SSE2 when the CPU
+// supports them and give the same results as transforming one at a time.
+void Aff3TransformVec2Array(Aff3 this, const Vec2* points, Vec2* out, int count);
+
+// `Aff3TransformVec2SoA` is like `Aff3TransformVec2Array` but for points
+// stored as separate arrays of their X and Y coordinates. The output arrays
+// may be the input ones.
+void Aff3TransformVec2SoA(Aff3 this, const float32* xs, const float32* ys, float32* outXs, float32* outYs, int count);
+
+// `Aff3TransformQuads` works out the corners of `count` rectangles, each with
+// its top left corner at (0, 0) and the size in `sizes[i]`, moved by
+// `transforms[i]`.
+//
+// `corners` needs room for `4 * count` points. Each rectangle's corners are
+// written top left, top right, bottom right then bottom left.
+void Aff3TransformQuads(const Aff3* transforms, const Vec2* sizes, Vec2* corners, int count);
+
+// `Aff3ConcatArray` sets `out[i]` to `Aff3Concat(this[i], aff3[i])` for
+// `count` pairs of matrices. `out` may be either of the inputs.
+void Aff3ConcatArray(const Aff3* this, const Aff3* aff3, Aff3* out, int count);
 
 // `Aff3Print` prints the matrix in a neat way. Useful for debugging.
 //
 // Note: if `NOPRINT` is defined, this may not print to the console.
 void Aff3Print(Aff3 this);
 
-#endif  // Aff3_H
\ No newline at end of file
+#include "mathInline.h"
+
+#endif  // Aff3_H
@@ -0,0 +1,134 @@
+#ifndef Broadphase_H
+#define Broadphase_H
+
+#include "graphics.h"
+#include "types.h"
+
+// `BroadphaseMode` picks how a `Broadphase` finds overlapping boxes.
+typedef enum PACK_ENUM BroadphaseMode {
+    // `BroadphaseMode_Grid` hashes boxes into a uniform grid of square cells
+    // and only checks boxes that share a cell. It works best when most bodies
+    // are around the size of a cell, since a box is added to every cell it
+    // covers.
+    BroadphaseMode_Grid,
+    // `BroadphaseMode_SweepAndPrune` keeps boxes sorted by their left edge
+    // and only checks boxes whose horizontal extents overlap. The order is
+    // kept between updates, so re-sorting bodies that moved a little is
+    // nearly free. It works best with bodies of very different sizes, as long
+    // as they aren't all stacked in a column.
+    BroadphaseMode_SweepAndPrune,
+} BroadphaseMode;
+
+// `BroadphasePair` is two bodies whose boxes overlap, with `a` below `b`.
+typedef struct BroadphasePair {
+    int a, b;
+} BroadphasePair;
+
+// `BroadphaseStats` describes the last `BroadphaseUpdate`.
+typedef struct BroadphaseStats {
+    // `bodies` is the number of bodies.
+    int bodies;
+    // `checks` is the number of pairs of boxes compared, which is what the
+    // broadphase keeps far below checking every pair.
+    int64 checks;
+    // `missedPairs` is the number of overlapping pairs that didn't fit in
+    // the pair buffer.
+    int missedPairs;
+} BroadphaseStats;
+
+// `BroadphaseEntry` is a body in a cell of the grid.
+//
+// It is not meant to be interacted with directly.
+typedef struct BroadphaseEntry {
+    int id;
+    // `next` is the next entry in the same bucket, or -1.
+    int next;
+    int cellX, cellY;
+} BroadphaseEntry;
+
+// `Broadphase` finds which bodies' bounding boxes overlap, so the game only
+// has to test those pairs for an actual collision.
+//
+// Bodies are added with `BroadphaseAdd`, which returns an id for them, and
+// moved with `BroadphaseMove`. Each `BroadphaseUpdate` then fills `pairs`
+// with every overlapping pair. The boxes are kept as separate arrays of their
+// edges, indexed by id. Boxes that only touch don't overlap.
+typedef struct Broadphase {
+    BroadphaseMode mode;
+
+    // `minXs`, `minYs`, `maxXs` and `maxYs` are the edges of every body's
+    // box. `used` is set for ids that belong to a body.
+    float32* minXs;
+    float32* minYs;
+    float32* maxXs;
+    float32* maxYs;
+    uint8* used;
+    int capacity;
+    // `freeIds` are ids that can be reused, and `nextId` the lowest id that
+    // has never been handed out.
+    int* freeIds;
+    int freeCount;
+    int nextId;
+
+    // `pairs` is filled by `BroadphaseUpdate`. It has room for
+    // `pairCapacity` pairs and never grows.
+    BroadphasePair* pairs;
+    int pairCount, pairCapacity;
+
+    // The grid: `buckets` is a hash table of the first entry in each bucket,
+    // with `bucketMask + 1` buckets. Entries are rebuilt by every update.
+    float32 cellSize;
+    int* buckets;
+    int bucketMask;
+    BroadphaseEntry* entries;
+    int entryCount, entryCapacity;
+
+    // Sweep and prune: `order` is the ids sorted by their left edge as of the
+    // last update, and `sortedMins` those left edges. `sorted` is set for ids
+    // that are in `order`.
+    int* order;
+    float32* sortedMins;
+    uint8* sorted;
+    int orderCount;
+
+    // `stamps` marks the bodies already found by the current query.
+    uint* stamps;
+    uint stamp;
+
+    BroadphaseStats stats;
+} Broadphase;
+
+// `BroadphaseInit` creates an empty broadphase with room for `capacity`
+// bodies, which grows if more are added, and for `pairCapacity` pairs, which
+// doesn't. `cellSize` is the size of a grid cell, and only matters for
+// `BroadphaseMode_Grid`.
+//
+// This returns true if the allocation was successful, else it returns false.
+bool BroadphaseInit(Broadphase* broadphase, BroadphaseMode mode, int capacity, int pairCapacity, float32 cellSize);
+
+// `BroadphaseAdd` adds a body with the bounding box `box` and returns its id,
+// or -1 if there's no memory left.
+int BroadphaseAdd(Broadphase* broadphase, Rect box);
+
+// `BroadphaseMove` sets the bounding box of the body with id `body`.
+void BroadphaseMove(Broadphase* broadphase, int body, Rect box);
+
+// `BroadphaseRemove` removes the body with id `body`. Its id may be handed
+// out again by `BroadphaseAdd`.
+void BroadphaseRemove(Broadphase* broadphase, int body);
+
+// `BroadphaseUpdate` fills `pairs` with every pair of bodies whose boxes
+// overlap, in no particular order.
+void BroadphaseUpdate(Broadphase* broadphase);
+
+// `BroadphaseQuery` finds the bodies whose boxes overlap `area`, writing up
+// to `capacity` of their ids to `ids`, and returns how many it wrote.
+//
+// Bodies are looked up by where they were at the last `BroadphaseUpdate`, so
+// bodies moved into `area` since then may be missed.
+int BroadphaseQuery(Broadphase* broadphase, Rect area, int* ids, int capacity);
+
+// `BroadphaseClose` frees the broadphase.
+void BroadphaseClose(Broadphase* broadphase);
+
+#endif  // Broadphase_H
@@ -0,0 +1,40 @@
+#ifndef Damage_H
+#define Damage_H
+
+#include "types.h"
+
+// `DAMAGE_MAX_RECTS` is the most rectangles a `Damage` keeps apart. Past this,
+// new rectangles are merged into existing ones.
+#ifndef DAMAGE_MAX_RECTS
+#define DAMAGE_MAX_RECTS 16
+#endif  // DAMAGE_MAX_RECTS
+
+// `DamageRect` is a rectangle of pixels with its top left corner at (`x`, `y`).
+typedef struct DamageRect {
+    int x, y;
+    int width, height;
+} DamageRect;
+
+// `Damage` collects the parts of a window that changed since it was last
+// presented, so only those need to be sent to the screen.
+//
+// Rectangles that overlap or nearly touch are merged as they are added, since
+// presenting a slightly larger area is cheaper than presenting many small
+// ones.
+typedef struct Damage {
+    DamageRect rects[DAMAGE_MAX_RECTS];
+    int count;
+} Damage;
+
+// `DamageAdd` marks the `width` by `height` rectangle at (`x`, `y`) as changed.
+void DamageAdd(Damage* damage, int x, int y, int width, int height);
+
+// `DamageClip` shrinks `rect` to the part inside a `width` by `height` area
+// with its top left corner at (0, 0). This returns false if nothing is left.
+bool DamageClip(DamageRect* rect, int width, int height);
+
+// `DamageClear` forgets every changed rectangle, usually once they have been
+// presented.
+void DamageClear(Damage* damage);
+
+#endif  // Damage_H
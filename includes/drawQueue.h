@@ -0,0 +1,126 @@
+#ifndef DrawQueue_H
+#define DrawQueue_H
+
+#include "types.h"
+
+// `BlendMode` selects how a draw's colors are mixed with what's already drawn.
+typedef enum PACK_ENUM BlendMode {
+    // `BlendMode_Opaque` replaces what's underneath.
+    BlendMode_Opaque,
+    // `BlendMode_Alpha` mixes by the source's alpha.
+    BlendMode_Alpha,
+    // `BlendMode_Premultiplied` mixes colors that were already multiplied by
+    // their alpha.
+    BlendMode_Premultiplied,
+    // `BlendMode_Additive` adds the source's colors (scaled by alpha), which
+    // is good for light and fire.
+    BlendMode_Additive,
+    // `BlendMode_Multiply` multiplies what's underneath by the source's
+    // colors, which is good for shadows.
+    BlendMode_Multiply,
+} BlendMode;
+
+// `DrawCommand` is a single draw call along with the OpenGL state it needs.
+typedef struct DrawCommand {
+    // `layer` is drawn in order from lowest to highest. Within a layer,
+    // draws are grouped by program, texture and blend mode, then sorted by
+    // `depth` (from 0 to 1, lowest first).
+    uint8 layer;
+    float32 depth;
+
+    uint32 program;
+    uint32 texture;
+    uint32 vertexArray;
+    BlendMode blend;
+    bool depthTest;
+
+    // `mode` is the kind of primitive, like `GL_TRIANGLES`.
+    uint32 mode;
+    // `first` and `count` are the range of vertices to draw, or of indices if
+    // `indexed` is set. Indices are 32 bit and offset by `baseVertex`.
+    int first, count;
+    bool indexed;
+    int baseVertex;
+} DrawCommand;
+
+// `DrawQueueStats` describes the work done by the last `DrawQueueFlush`.
+typedef struct DrawQueueStats {
+    // `commands` is the number of commands queued.
+    int commands;
+    // `drawCalls` is the number of draw calls made, which is lower than
+    // `commands` when neighboring commands could be merged.
+    int drawCalls;
+    // `stateChanges` is the number of state changes made, and
+    // `skippedChanges` the number skipped because the state was already set.
+    int stateChanges;
+    int skippedChanges;
+} DrawQueueStats;
+
+// `DrawState` is the OpenGL state last set by a `DrawQueue`, so setting it to
+// the same thing again can be skipped.
+//
+// It is not meant to be interacted with directly.
+typedef struct DrawState {
+    uint32 program;
+    uint32 texture;
+    uint32 vertexArray;
+    int blend;
+    int depthTest;
+} DrawState;
+
+// `DrawQueue` collects draw calls in any order and makes them sorted by a
+// 64 bit key, so switching programs, textures and blend modes happens as
+// rarely as possible.
+//
+// Each command's key is its layer, program, texture, blend mode and depth
+// from most to least significant. Keys are sorted with a radix sort, which is
+// stable, so commands with equal keys are drawn in the order they were
+// queued. Only the state that actually changes between commands is set. The
+// queue forgets what it set at the start of every flush, so other drawing in
+// between flushes is fine.
+//
+// Commands that share all their state and draw neighboring ranges of the same
+// vertex array are merged into one draw call.
+//
+// The queue sets the program, texture unit 0, vertex array, blending and depth
+// testing itself, so any other state (like uniforms) has to be the same for
+// every command that shares a program. A queue needs at least OpenGL 3.2.
+typedef struct DrawQueue {
+    DrawCommand* commands;
+    // `keys` holds the sort key of every command and `order` the index of
+    // the command each key belongs to. `sortKeys` and `sortOrder` are scratch
+    // space for sorting them.
+    uint64* keys;
+    uint32* order;
+    uint64* sortKeys;
+    uint32* sortOrder;
+    int count, capacity;
+
+    DrawState state;
+    DrawQueueStats stats;
+} DrawQueue;
+
+// `DrawQueueInit` creates an empty queue with room for `capacity` commands.
+// The queue grows if more are queued.
+//
+// The window's OpenGL context must be current. This returns false if the
+// context is too old.
+bool DrawQueueInit(DrawQueue* queue, int capacity);
+
+// `DrawQueueKey` returns the sort key of `command`.
+uint64 DrawQueueKey(const DrawCommand* command);
+
+// `DrawQueuePush` queues `command` to be drawn by the next `DrawQueueFlush`.
+void DrawQueuePush(DrawQueue* queue, DrawCommand command);
+
+// `DrawQueueFlush` sorts and draws every queued command, then empties the
+// queue.
+//
+// Afterwards, the program, texture, vertex array, blending and depth testing
+// are left however the last command set them.
+void DrawQueueFlush(DrawQueue* queue);
+
+// `DrawQueueClose` frees the queue.
+void DrawQueueClose(DrawQueue* queue);
+
+#endif  // DrawQueue_H
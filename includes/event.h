@@ -0,0 +1,151 @@
+#ifndef Event_H
+#define Event_H
+
+#include "gamepad.h"
+#include "keyboard.h"
+#include "mouse.h"
+#include "types.h"
+
+typedef struct Window Window;
+
+// `INPUT_QUEUE_SIZE` is the maximum number of input events that can be queued
+// in a single frame. It must be a power of 2.
+#ifndef INPUT_QUEUE_SIZE
+#define INPUT_QUEUE_SIZE 256
+#endif  // INPUT_QUEUE_SIZE
+
+// `InputEventType` specifies what kind of input an `InputEvent` describes and
+// which of its fields are set.
+typedef enum PACK_ENUM InputEventType {
+    // `InputEventType_KeyPress` and `InputEventType_KeyRelease` set `key`.
+    InputEventType_KeyPress,
+    InputEventType_KeyRelease,
+    // `InputEventType_Char` sets `character`.
+    InputEventType_Char,
+    // `InputEventType_MousePress` and `InputEventType_MouseRelease` set
+    // `mouse.button` as well as `mouse.x` and `mouse.y`.
+    InputEventType_MousePress,
+    InputEventType_MouseRelease,
+    // `InputEventType_MouseMove` sets `mouse.x` and `mouse.y`.
+    InputEventType_MouseMove,
+    // `InputEventType_Scroll` sets `scroll.x` and `scroll.y` to how far the
+    // wheel moved.
+    InputEventType_Scroll,
+    // `InputEventType_GamepadPress` and `InputEventType_GamepadRelease` set
+    // `gamepad.playerID` and `gamepad.button`.
+    InputEventType_GamepadPress,
+    InputEventType_GamepadRelease,
+    // `InputEventType_GamepadAxis` sets `gamepad.playerID`, `gamepad.axis`
+    // and `gamepad.value`.
+    InputEventType_GamepadAxis,
+    // `InputEventType_GamepadConnect` and `InputEventType_GamepadDisconnect`
+    // set `gamepad.playerID`.
+    InputEventType_GamepadConnect,
+    InputEventType_GamepadDisconnect,
+} InputEventType;
+
+// `InputEvent` describes a single change in input and when it happened.
+//
+// While functions like `KeyJustPressed` only tell you what changed between
+// frames, events tell you everything that happened in the order it happened.
+// That means a key tapped faster than a frame isn't missed and you can tell
+// exactly when in the frame a button was pressed.
+typedef struct InputEvent {
+    InputEventType type;
+    // `time` is when the event happened in nanoseconds, measured with the same
+    // clock as `WindowTimeNano`.
+    int64 time;
+    union {
+        Key key;
+        rune character;
+        struct {
+            MouseButton button;
+            int x, y;
+        } mouse;
+        struct {
+            int x, y;
+        } scroll;
+        struct {
+            int playerID;
+            GamepadButton button;
+            GamepadAxis axis;
+            float32 value;
+        } gamepad;
+    };
+} InputEvent;
+
+// `InputQueue` is a fixed size ring buffer of `InputEvent`s.
+//
+// Events are stored in place so queuing one never allocates. One thread may
+// push events while another pops them without any locks.
+typedef struct InputQueue {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    uint32 head;
+    uint32 tail;
+    // `dropped` counts events that didn't fit because the queue was full.
+    uint32 dropped;
+} InputQueue;
+
+// `InputScriptEntry` is an input event scheduled to happen on a certain frame.
+typedef struct InputScriptEntry {
+    // `frame` counts calls to `WindowUpdate`, starting with 0 for the first
+    // call.
+    int64 frame;
+    InputEvent event;
+} InputScriptEntry;
+
+// `InputScript` is a list of input events to play back, one frame at a time.
+// This is how headless windows receive input (see `WindowConfig.headless`).
+//
+// Entries must be sorted by `frame`. The `time` of each event is ignored and
+// set to the time it's played back.
+typedef struct InputScript {
+    const InputScriptEntry* entries;
+    int count;
+} InputScript;
+
+// `WindowPollEvent` removes the oldest input event received by the last call to
+// `WindowUpdate` and copies it into `event`.
+//
+// This returns false once there are no more events. Events that weren't polled
+// are discarded on the next call to `WindowUpdate`.
+bool WindowPollEvent(Window* window, InputEvent* event);
+
+// `InputEventApply` updates the input state of `window` as if `event` had just
+// happened, then queues it so it can be polled with `WindowPollEvent`.
+//
+// This is used to feed input from sources other than the platform, like an
+// `InputScript`. Events for keys or buttons that don't exist are ignored.
+void InputEventApply(Window* window, const InputEvent* event);
+
+// `InputScriptPlay` applies every event in `script` scheduled for `frame` or
+// earlier, starting from the entry at `*index`. `*index` is moved past the
+// entries that were applied.
+void InputScriptPlay(Window* window, const InputScript* script, int* index, int64 frame);
+
+// `InputQueuePush` appends `event` to the end of the queue. This returns false
+// (and counts the event as dropped) if the queue is full.
+//
+// Only one thread should push to a queue.
+bool InputQueuePush(InputQueue* queue, InputEvent event);
+
+// `InputQueuePop` removes the event at the front of the queue and copies it to
+// `event`. This returns false if the queue is empty.
+//
+// Only one thread should pop from a queue.
+bool InputQueuePop(InputQueue* queue, InputEvent* event);
+
+// `InputQueueClear` discards every event waiting in the queue. It should only
+// be called by the thread that pops from the queue.
+void InputQueueClear(InputQueue* queue);
+
+// `InputTimeFromMillis` converts an event timestamp in milliseconds from some
+// other clock (like the X server's) into `WindowTimeNano` time.
+//
+// `offset` should start at 0 and is updated as more timestamps are seen so the
+// difference between the two clocks is estimated more accurately over time.
+//
+// This is used internally by the platform implementations.
+int64 InputTimeFromMillis(int64* offset, int64 millis);
+
+#endif  // Event_H
@@ -0,0 +1,31 @@
+#ifndef FastMath_H
+#define FastMath_H
+
+#include "types.h"
+
+// `FastSinCos` sets `sin` and `cos` to the sine and cosine of `angle` (in
+// radians) at once. It costs about the same as a single `sinf` and doesn't
+// branch on the angle, so it's fastest compared to `sinf` and `cosf` when the
+// angles are unpredictable.
+//
+// The angle is reduced to within π/4 of a multiple of π/2, where the sine and
+// cosine are worked out with minimax polynomials. The result is off by at most
+// 1e-7 for angles up to 4096π in size and 5e-7 up to 16384π. Past that it
+// quickly gets less accurate, so keep angles small by wrapping them.
+void FastSinCos(float32 angle, float32* sin, float32* cos);
+
+// `FastSin` returns the sine of `angle` (in radians) like `FastSinCos`.
+float32 FastSin(float32 angle);
+
+// `FastCos` returns the cosine of `angle` (in radians) like `FastSinCos`.
+float32 FastCos(float32 angle);
+
+// `SinCosArray` works out `FastSinCos` for `count` angles, using AVX2 or SSE2
+// to do 8 or 4 at a time when the CPU supports them. The results are the same
+// as calling `FastSinCos` for each angle.
+//
+// Either `sins` or `coss` may be nil if they aren't needed, and either may be
+// `angles` to replace the angles with the results.
+void SinCosArray(const float32* angles, float32* sins, float32* coss, int count);
+
+#endif  // FastMath_H
@@ -0,0 +1,122 @@
+#ifndef Framebuffer_H
+#define Framebuffer_H
+
+#include "damage.h"
+#include "graphics.h"
+#include "types.h"
+
+typedef struct Window Window;
+
+// `Pixel` is a color laid out the way a `Framebuffer` stores it, which is the
+// layout X servers and Windows use for 32 bit images.
+typedef struct Pixel {
+    uint8 B;
+    uint8 G;
+    uint8 R;
+    uint8 A;
+} Pixel;
+
+// `FramebufferNative` is the platforms native implementation of a
+// framebuffer.
+//
+// It is not meant to be interacted with directly.
+typedef struct FramebufferNative FramebufferNative;
+
+// `Framebuffer` is an image in main memory that is drawn by the CPU and then
+// shown in a window, as an alternative to drawing with OpenGL.
+//
+// On Linux the image is shared with the X server (with the MIT-SHM extension)
+// so presenting it doesn't copy it through the X connection. If the extension
+// isn't available (like when the X server is on another machine) the pixels
+// are sent over the connection instead.
+//
+// Building with `MINO_NO_GL` (`make GRAPHICS=software`) leaves OpenGL out of
+// Mino entirely, making this the only way to draw.
+typedef struct Framebuffer {
+    // `pixels` holds the image from the top row to the bottom.
+    Pixel* pixels;
+    int width, height;
+    // `stride` is how many pixels there are from the start of one row to the
+    // start of the next. Rows may be padded so this can be more than `width`.
+    int stride;
+    // `damage` is the parts of the window changed since the framebuffer was
+    // last presented. Drawing with the functions below adds to it
+    // automatically.
+    Damage damage;
+
+    // `screen` is the window sized image that is presented. It is the same
+    // as `pixels` unless a virtual resolution is set, in which case `pixels`
+    // is scaled up by `scale` into `screen` with its top left corner at
+    // (`offsetX`, `offsetY`).
+    Pixel* screen;
+    int screenWidth, screenHeight, screenStride;
+    int scale, offsetX, offsetY;
+
+    FramebufferNative* native;
+} Framebuffer;
+
+// `FramebufferInit` creates a framebuffer the size of `window`. It returns
+// true when successful or false if there was an error.
+//
+// The framebuffer keeps that size if the window is resized later, so the
+// window should be created at the size it's meant to be drawn at.
+//
+// Don't use `GraphicsInit` on the same window, since OpenGL would draw over
+// the framebuffer. Remember to call `FramebufferClose` before disposing the
+// window.
+bool FramebufferInit(Framebuffer* framebuffer, Window* window);
+
+// `FramebufferPresent` shows the parts of the framebuffer that changed since
+// the last present in its window. If the window system lost what was in the
+// window (like when it was uncovered), the whole framebuffer is shown.
+//
+// Once this returns, the window system is done reading the pixels so it is
+// safe to start drawing the next frame.
+void FramebufferPresent(Framebuffer* framebuffer);
+
+// `FramebufferClose` frees the framebuffer.
+void FramebufferClose(Framebuffer* framebuffer);
+
+// `FramebufferAddDamage` marks the `width` by `height` rectangle at (`x`, `y`)
+// as changed so the next `FramebufferPresent` shows it. Only needed after
+// writing to `pixels` directly.
+void FramebufferAddDamage(Framebuffer* framebuffer, int x, int y, int width, int height);
+
+// `FramebufferSetVirtualResolution` makes the framebuffer `width` by `height`
+// pixels no matter how big the window is. When presenting, it's scaled up by
+// the largest whole number that fits in the window, leaving a black border
+// around it.
+//
+// Drawing fewer pixels is faster, and the scaling only touches the damaged
+// parts. A `width` or `height` of 0 goes back to the size of the window. This
+// returns false if the resolution is bigger than the window was when the
+// framebuffer was created.
+bool FramebufferSetVirtualResolution(Framebuffer* framebuffer, int width, int height);
+
+// `FramebufferUpscale` scales the part of `pixels` covering `rect` (in
+// `screen` coordinates) up into `screen`.
+//
+// This is used internally by the platform implementations.
+void FramebufferUpscale(Framebuffer* framebuffer, DamageRect rect);
+
+// `ColorToPixel` converts `color` to the layout a `Framebuffer` stores.
+Pixel ColorToPixel(Color color);
+
+// `FramebufferFill` sets every pixel of the `width` by `height` rectangle with
+// its top left corner at (`x`, `y`) to `color`. Anything outside of the
+// framebuffer is ignored.
+void FramebufferFill(Framebuffer* framebuffer, int x, int y, int width, int height, Color color);
+
+// `FramebufferBlit` copies an image (rows of `width` colors from top to bottom)
+// into the framebuffer with its top left corner at (`x`, `y`). Alpha is copied
+// as is rather than blended.
+void FramebufferBlit(Framebuffer* framebuffer, int x, int y, const Color* pixels, int width, int height);
+
+// `FramebufferBlend` draws an image like `FramebufferBlit` but mixes it with
+// what's already in the framebuffer based on its alpha.
+//
+// Runs of fully opaque or fully transparent pixels (common in sprites) are
+// handled without doing any blending.
+void FramebufferBlend(Framebuffer* framebuffer, int x, int y, const Color* pixels, int width, int height);
+
+#endif  // Framebuffer_H
@@ -0,0 +1,109 @@
+#ifndef GLLoader_H
+#define GLLoader_H
+
+#if defined(PLATFORM_Windows)
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "types.h"
+
+typedef struct Window Window;
+
+// `GL_FUNCTIONS` lists the OpenGL functions newer than OpenGL 1.1 that Mino
+// uses. Platforms only export the OpenGL 1.1 functions directly, so everything
+// else has to be looked up at runtime once a context exists.
+//
+// Each entry is `X(type, name)` where the function is called `gl<name>`.
+#define GL_FUNCTIONS(X)                                               \
+    X(PFNGLACTIVETEXTUREPROC, ActiveTexture)                          \
+    X(PFNGLATTACHSHADERPROC, AttachShader)                            \
+    X(PFNGLBEGINQUERYPROC, BeginQuery)                                \
+    X(PFNGLBINDBUFFERPROC, BindBuffer)                                \
+    X(PFNGLBINDFRAMEBUFFERPROC, BindFramebuffer)                      \
+    X(PFNGLBINDRENDERBUFFERPROC, BindRenderbuffer)                    \
+    X(PFNGLBINDVERTEXARRAYPROC, BindVertexArray)                      \
+    X(PFNGLBUFFERDATAPROC, BufferData)                                \
+    X(PFNGLBUFFERSTORAGEPROC, BufferStorage)                          \
+    X(PFNGLBUFFERSUBDATAPROC, BufferSubData)                          \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, CheckFramebufferStatus)        \
+    X(PFNGLCLIENTWAITSYNCPROC, ClientWaitSync)                        \
+    X(PFNGLCOMPILESHADERPROC, CompileShader)                          \
+    X(PFNGLCREATEPROGRAMPROC, CreateProgram)                          \
+    X(PFNGLCREATESHADERPROC, CreateShader)                            \
+    X(PFNGLDELETEBUFFERSPROC, DeleteBuffers)                          \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, DeleteFramebuffers)                \
+    X(PFNGLDELETEPROGRAMPROC, DeleteProgram)                          \
+    X(PFNGLDELETEQUERIESPROC, DeleteQueries)                          \
+    X(PFNGLDELETERENDERBUFFERSPROC, DeleteRenderbuffers)              \
+    X(PFNGLDELETESHADERPROC, DeleteShader)                            \
+    X(PFNGLDELETESYNCPROC, DeleteSync)                                \
+    X(PFNGLDELETEVERTEXARRAYSPROC, DeleteVertexArrays)                \
+    X(PFNGLDRAWELEMENTSBASEVERTEXPROC, DrawElementsBaseVertex)        \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, EnableVertexAttribArray)      \
+    X(PFNGLENDQUERYPROC, EndQuery)                                    \
+    X(PFNGLFENCESYNCPROC, FenceSync)                                  \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, FramebufferRenderbuffer)      \
+    X(PFNGLFRAMEBUFFERTEXTURE2DPROC, FramebufferTexture2D)            \
+    X(PFNGLGENBUFFERSPROC, GenBuffers)                                \
+    X(PFNGLGENFRAMEBUFFERSPROC, GenFramebuffers)                      \
+    X(PFNGLGENQUERIESPROC, GenQueries)                                \
+    X(PFNGLGENRENDERBUFFERSPROC, GenRenderbuffers)                    \
+    X(PFNGLGENVERTEXARRAYSPROC, GenVertexArrays)                      \
+    X(PFNGLGETPROGRAMINFOLOGPROC, GetProgramInfoLog)                  \
+    X(PFNGLGETPROGRAMIVPROC, GetProgramiv)                            \
+    X(PFNGLGETQUERYOBJECTIVPROC, GetQueryObjectiv)                    \
+    X(PFNGLGETQUERYOBJECTUI64VPROC, GetQueryObjectui64v)              \
+    X(PFNGLGETSHADERINFOLOGPROC, GetShaderInfoLog)                    \
+    X(PFNGLGETSHADERIVPROC, GetShaderiv)                              \
+    X(PFNGLGETSTRINGIPROC, GetStringi)                                \
+    X(PFNGLGETUNIFORMLOCATIONPROC, GetUniformLocation)                \
+    X(PFNGLLINKPROGRAMPROC, LinkProgram)                              \
+    X(PFNGLMAPBUFFERRANGEPROC, MapBufferRange)                        \
+    X(PFNGLQUERYCOUNTERPROC, QueryCounter)                            \
+    X(PFNGLRENDERBUFFERSTORAGEPROC, RenderbufferStorage)              \
+    X(PFNGLSHADERSOURCEPROC, ShaderSource)                            \
+    X(PFNGLUNIFORM1IPROC, Uniform1i)                                  \
+    X(PFNGLUNIFORM2FPROC, Uniform2f)                                  \
+    X(PFNGLUNMAPBUFFERPROC, UnmapBuffer)                              \
+    X(PFNGLUSEPROGRAMPROC, UseProgram)                                \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, VertexAttribPointer)
+
+// `GLFunctions` holds a pointer to every function in `GL_FUNCTIONS`. Functions
+// the driver doesn't have are nil.
+typedef struct GLFunctions {
+#define X(type, name) type name;
+    GL_FUNCTIONS(X)
+#undef X
+} GLFunctions;
+
+// `GL` holds the OpenGL functions loaded by `GLLoad`. Call them like
+// `GL.BindBuffer(GL_ARRAY_BUFFER, buffer)`.
+extern GLFunctions GL;
+
+// `GLLoad` looks up every function in `GL_FUNCTIONS` for the context of
+// `window`. `GraphicsInit` calls this so you shouldn't need to.
+//
+// This returns false if any function is missing, though the ones that were
+// found are still loaded.
+bool GLLoad(Window* window);
+
+// `GLVersionAtLeast` returns true if the current context's OpenGL version is
+// at least `major`.`minor`.
+//
+// Drivers often return a function pointer for any name, even for functions
+// they can't run, so check the version (or `GLExtensionSupported`) before
+// relying on a loaded function.
+bool GLVersionAtLeast(int major, int minor);
+
+// `GLExtensionSupported` returns true if the current context has the OpenGL
+// extension `name` (like "GL_ARB_buffer_storage").
+bool GLExtensionSupported(const char* name);
+
+// `GLBuildProgram` compiles and links a shader program from the GLSL source of
+// a vertex and a fragment shader. This returns 0 and prints the error if
+// either fails to compile or they fail to link.
+uint32 GLBuildProgram(const char* vertexSource, const char* fragmentSource);
+
+#endif  // GLLoader_H
@@ -2,7 +2,8 @@
 #define Graphics_H
 
 #include "types.h"
-#include "window.h"
+
+typedef struct Window Window;
 
 // `Color` represents an RGBA color value.
 //
@@ -19,9 +20,77 @@ typedef struct Color {
 // `ColorHex` creates a Color object using a hexadecimal value in ARGB format.
 Color ColorHex(const uint32 color);
 
+// `Rect` is an axis aligned rectangle. `X` and `Y` are its top left corner.
+typedef struct Rect {
+    float32 X, Y;
+    float32 Width, Height;
+} Rect;
+
+// `Texture` is an image stored on the GPU that can be drawn with a
+// `SpriteBatch`.
+typedef struct Texture {
+    uint32 id;
+    int width, height;
+} Texture;
+
+// `TextureInit` uploads `pixels` (rows of `width` colors from top to bottom) to
+// a new texture. `pixels` may be nil to leave the texture blank.
+//
+// Textures are sampled with nearest filtering so pixel art stays sharp. The
+// window's OpenGL context must be current.
+bool TextureInit(Texture* texture, int width, int height, const Color* pixels);
+
+// `TextureUpdate` replaces the pixels of `texture` inside `area` with `pixels`,
+// which holds `area.Width` colors per row.
+void TextureUpdate(Texture* texture, Rect area, const Color* pixels);
+
+// `TextureClose` frees the texture on the GPU.
+void TextureClose(Texture* texture);
+
+// `GraphicsProfile` selects which OpenGL profile a context is created with.
+typedef enum PACK_ENUM GraphicsProfile {
+    // `GraphicsProfile_Compatibility` keeps the old fixed function API (like
+    // `glBegin` and `glEnd`) available alongside the modern one.
+    GraphicsProfile_Compatibility,
+    // `GraphicsProfile_Core` removes the old fixed function API. Drivers have
+    // less state to track and validate, so core contexts can be faster.
+    GraphicsProfile_Core,
+} GraphicsProfile;
+
+// `GraphicsConfig` specifies the kind of OpenGL context `GraphicsInit` creates.
+// It is passed to `WindowInit` through `WindowConfig.graphics`, since the
+// window has to be created with a matching pixel format.
+//
+// The zero value creates a compatibility context of whatever version the
+// driver prefers.
+typedef struct GraphicsConfig {
+    // `majorVersion` and `minorVersion` are the minimum OpenGL version to
+    // create. If `majorVersion` is 0, the driver picks the version.
+    int majorVersion, minorVersion;
+    GraphicsProfile profile;
+
+    // `srgb` makes the default framebuffer convert colors from linear to sRGB
+    // when they're written. It is ignored if the driver doesn't support it.
+    bool srgb;
+
+    // `samples` is the number of samples per pixel to use for multisample
+    // anti-aliasing (MSAA). 0 turns it off. It is ignored if the driver
+    // doesn't support it.
+    int samples;
+
+    // `noError` creates a context that skips error checking. Invalid calls
+    // have undefined results instead of raising errors, in exchange for less
+    // overhead on every call. This is meant for release builds and is ignored
+    // if the driver doesn't support it.
+    bool noError;
+} GraphicsConfig;
+
 // `GraphicsInit` creates an OpenGL context for the current window. It returns
 // true when successful or false if there was an error.
 //
+// The context is created with the settings from `WindowConfig.graphics`. This
+// fails if the requested OpenGL version or profile isn't available.
+//
 // Remember to close the graphics api by calling `GraphicsClose`. (This should
 // be done before disposing the window)
 bool GraphicsInit(Window* window);
@@ -34,7 +103,64 @@ void GraphicsClose(Window* window);
 // `GraphicsMakeCurrent` makes the OpenGL api use this window and its context.
 //
 // This should be called before doing OpenGL operations to ensure that OpenGL
-// functions target this window and context
+// functions target this window and context. It does nothing if they already
+// are, so it's cheap to call every frame.
 void GraphicsMakeCurrent(Window* window);
 
+// `GraphicsPresent` shows what has been drawn this frame.
+//
+// Calling this is optional since `WindowUpdate` shows the frame if it hasn't
+// been yet. Presenting as soon as drawing is done and calling `WindowUpdate`
+// right after means input is read after the swap (which may block waiting
+// for vsync) rather than before it, so the next frame starts with the newest
+// input and can be drawn straight away.
+void GraphicsPresent(Window* window);
+
+// `GraphicsAddDamage` marks the `width` by `height` rectangle at (`x`, `y`)
+// (in pixels from the top left corner) as changed this frame.
+//
+// If anything is marked, the next `WindowUpdate` only copies the marked parts
+// of the back buffer to the screen instead of swapping buffers, and the back
+// buffer keeps its contents. Games that change little each frame can then
+// redraw just those parts. Frames where nothing was marked are swapped as
+// usual. Copying doesn't wait for vsync, so pace these frames with a
+// `FramePacer`.
+//
+// This is ignored where the driver can't present part of a window (like on
+// Windows), so the whole frame should still be drawn the first time.
+void GraphicsAddDamage(Window* window, int x, int y, int width, int height);
+
+// `GraphicsGetProcAddress` looks up an OpenGL function by name (like
+// "glBindBuffer") for the context of `window`. This returns nil if the driver
+// doesn't have it.
+//
+// The functions Mino uses are already loaded into `GL` (see `glLoader.h`) so
+// this is only needed for anything else.
+void* GraphicsGetProcAddress(Window* window, const char* name);
+
+// `GraphicsSetSwapInterval` sets how many screen refreshes `WindowUpdate`
+// waits for before showing a new frame (vsync).
+//
+//  - 0 shows frames as soon as they're ready. This can tear and runs as fast
+//    as possible, keeping the GPU busy.
+//  - 1 waits for the next refresh, which caps the frame rate to the refresh
+//    rate of the screen. 2 waits for 2 refreshes, and so on.
+//  - Negative values are adaptive vsync: they wait like their positive
+//    counterpart unless the frame is already late, in which case it is shown
+//    right away (and may tear) instead of stuttering for a whole refresh.
+//
+// If adaptive vsync isn't supported, the positive interval is used instead.
+// This returns true if the requested interval is now active. Use
+// `GraphicsGetSwapInterval` to find out what was actually chosen.
+//
+// With vsync on, `WindowUpdate` paces frames by itself so there's no need to
+// sleep (or use a `FramePacer`) in your game loop.
+bool GraphicsSetSwapInterval(Window* window, int interval);
+
+// `GraphicsGetSwapInterval` returns the swap interval currently in use (see
+// `GraphicsSetSwapInterval`). If the driver can't report it, this returns the
+// last interval that was set, or 1 (what most drivers default to) if it was
+// never set.
+int GraphicsGetSwapInterval(Window* window);
+
 #endif  // Graphics_H
\ No newline at end of file
@@ -169,4 +169,57 @@ enum PACK_ENUM Key {
     Key_Invalid = ~0,
 };
 
+// `KEY_SET_WORDS` is the number of 64 bit words needed to hold one bit for
+// every key code.
+#define KEY_SET_WORDS ((Key_Count + 63) / 64)
+
+// `KeySet` holds one bit for every key code.
+//
+// Storing keys as bits means checking every key at once only takes a couple of
+// bitwise operations instead of looping over each key.
+typedef struct KeySet {
+    uint64 bits[KEY_SET_WORDS];
+} KeySet;
+
+// `KeySetHas` returns true if `key` is in the set.
+bool KeySetHas(KeySet set, Key key);
+
+// `KeySetPut` adds `key` to the set if `value` is true, otherwise it removes
+// `key` from the set.
+void KeySetPut(KeySet* set, Key key, bool value);
+
+// `KeySetUpdateModifiers` updates the combined modifier keys (like `Key_Ctrl`)
+// after the left or right variant (like `Key_LeftCtrl`) has changed. Other keys
+// are ignored.
+void KeySetUpdateModifiers(KeySet* set, Key key);
+
+// `KeySetEmpty` returns true if there are no keys in the set.
+bool KeySetEmpty(KeySet set);
+
+// `KeySetNext` removes the lowest key code from `set` and stores it in `key`.
+// This returns false once the set is empty, which makes it easy to loop over
+// the keys in a set:
+//
+//	KeySet pressed = KeysJustPressed(window);
+//	Key key;
+//	while (KeySetNext(&pressed, &key)) {
+//	    // ...
+//	}
+bool KeySetNext(KeySet* set, Key* key);
+
+// `KeysPressed` returns the set of keys that are currently pressed.
+KeySet KeysPressed(Window* window);
+
+// `KeysChanged` returns the set of keys that have been pressed or released
+// since the last call to `WindowUpdate`.
+KeySet KeysChanged(Window* window);
+
+// `KeysJustPressed` returns the set of keys that have just been pressed since
+// the last call to `WindowUpdate`.
+KeySet KeysJustPressed(Window* window);
+
+// `KeysJustReleased` returns the set of keys that have just been released since
+// the last call to `WindowUpdate`.
+KeySet KeysJustReleased(Window* window);
+
 #endif  // Keyboard_H
\ No newline at end of file
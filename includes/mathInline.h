@@ -0,0 +1,177 @@
+#ifndef MathInline_H
+#define MathInline_H
+
+// `mathInline.h` holds the bodies of the `Vec2` and `Aff3` functions. They're
+// compiled as `static inline` into every file that includes `vec2.h` or
+// `aff3.h` if `MINO_INLINE_MATH` is defined, and otherwise only into the one
+// file that defines `MINO_MATH_IMPLEMENTATION`.
+//
+// This is included at the end of `aff3.h`, so both types are complete.
+
+#include <math.h>
+
+#include "aff3.h"
+#include "consts.h"
+#include "fastMath.h"
+#include "types.h"
+#include "vec2.h"
+
+#if defined(MINO_INLINE_MATH) || defined(MINO_MATH_IMPLEMENTATION)
+
+MATH_API Vec2 Vec2Add(Vec2 this, Vec2 vec) {
+    return (Vec2){this.X + vec.X, this.Y + vec.Y};
+}
+
+MATH_API Vec2 Vec2Sub(Vec2 this, Vec2 vec) {
+    return (Vec2){this.X - vec.X, this.Y - vec.Y};
+}
+
+MATH_API Vec2 Vec2Scale(Vec2 this, float32 scale) {
+    return (Vec2){this.X * scale, this.Y * scale};
+}
+
+MATH_API Vec2 Vec2Multiply(Vec2 this, Vec2 vec) {
+    return (Vec2){this.X * vec.X, this.Y * vec.Y};
+}
+
+MATH_API Vec2 Vec2Negate(Vec2 this) {
+    return (Vec2){-this.X, -this.Y};
+}
+
+MATH_API float32 Vec2Dot(Vec2 this, Vec2 vec) {
+    return this.X * vec.X + this.Y * vec.Y;
+}
+
+MATH_API float32 Vec2Cross(Vec2 this, Vec2 vec) {
+    return this.X * vec.Y - this.Y * vec.X;
+}
+
+MATH_API float32 Vec2LengthSquared(Vec2 this) {
+    return this.X * this.X + this.Y * this.Y;
+}
+
+MATH_API float32 Vec2Length(Vec2 this) {
+    return sqrtf(this.X * this.X + this.Y * this.Y);
+}
+
+MATH_API float32 Vec2Distance(Vec2 this, Vec2 vec) {
+    return Vec2Length(Vec2Sub(this, vec));
+}
+
+MATH_API Vec2 Vec2Normalize(Vec2 this) {
+    float32 length = Vec2Length(this);
+    if (length == 0) return (Vec2){0, 0};
+    return Vec2Scale(this, 1 / length);
+}
+
+MATH_API Vec2 Vec2Lerp(Vec2 this, Vec2 vec, float32 t) {
+    return (Vec2){
+        this.X + (vec.X - this.X) * t,
+        this.Y + (vec.Y - this.Y) * t,
+    };
+}
+
+MATH_API Vec2 Vec2TransformAff3(Vec2 this, Aff3 aff3) {
+    return Aff3TransformVec2(aff3, this);
+}
+
+MATH_API Vec2 Vec2Rotate(Vec2 this, Vec2 pivot, float32 angle) {
+    angle *= TO_RAD;
+#if defined(MINO_FAST_MATH)
+    float32 sin, cos;
+    FastSinCos(angle, &sin, &cos);
+#else
+    float32 sin = sinf(angle), cos = cosf(angle);
+#endif
+    float32 dx = this.X - pivot.X;
+    float32 dy = this.Y - pivot.Y;
+
+    return (Vec2){
+        .X = cos * dx - sin * dy + pivot.X,
+        .Y = sin * dx + cos * dy + pivot.Y,
+    };
+}
+
+MATH_API Aff3 Aff3Identity() {
+    return (Aff3){.A = 1, .B = 0, .C = 0, .D = 1, .TX = 0, .TY = 0};
+}
+
+MATH_API Aff3 Aff3Concat(Aff3 this, Aff3 aff3) {
+    return (Aff3){
+        .A = this.A * aff3.A + this.B * aff3.C,
+        .B = this.A * aff3.B + this.B * aff3.D,
+        .C = this.C * aff3.A + this.D * aff3.C,
+        .D = this.C * aff3.B + this.D * aff3.D,
+        .TX = this.TX * aff3.A + this.TY * aff3.C + aff3.TX,
+        .TY = this.TX * aff3.B + this.TY * aff3.D + aff3.TY,
+    };
+}
+
+MATH_API Aff3 Aff3Invert(Aff3 this) {
+    float32 determinant = this.A * this.D - this.B * this.C;
+    if (determinant == 0) {
+        return (Aff3){.A = 0, .B = 0, .C = 0, .D = 0, .TX = -this.TX, .TY = -this.TY};
+    }
+    float32 inverse = 1 / determinant;
+    float32 a = this.D * inverse, b = -this.B * inverse;
+    float32 c = -this.C * inverse, d = this.A * inverse;
+    return (Aff3){
+        .A = a,
+        .B = b,
+        .C = c,
+        .D = d,
+        .TX = -a * this.TX - c * this.TY,
+        .TY = -b * this.TX - d * this.TY,
+    };
+}
+
+MATH_API Aff3 Aff3Rotate(Aff3 this, float32 angle) {
+    angle *= TO_RAD;
+#if defined(MINO_FAST_MATH)
+    float32 sin, cos;
+    FastSinCos(angle, &sin, &cos);
+#else
+    float32 sin = sinf(angle), cos = cosf(angle);
+#endif
+    return (Aff3){
+        .A = this.A * cos - this.B * sin,
+        .B = this.A * sin + this.B * cos,
+        .C = this.C * cos - this.D * sin,
+        .D = this.C * sin + this.D * cos,
+        .TX = this.TX * cos - this.TY * sin,
+        .TY = this.TX * sin + this.TY * cos,
+    };
+}
+
+MATH_API Aff3 Aff3Scale(Aff3 this, float32 x, float32 y) {
+    return (Aff3){
+        .A = this.A * x,
+        .B = this.B * y,
+        .C = this.C * x,
+        .D = this.D * y,
+        .TX = this.TX * x,
+        .TY = this.TY * y,
+    };
+}
+
+MATH_API Aff3 Aff3Translate(Aff3 this, float32 x, float32 y) {
+    return (Aff3){
+        .A = this.A,
+        .B = this.B,
+        .C = this.C,
+        .D = this.D,
+        .TX = this.TX + x,
+        .TY = this.TY + y,
+    };
+}
+
+MATH_API Vec2 Aff3TransformVec2(Aff3 this, Vec2 vec) {
+    return (Vec2){
+        .X = this.A * vec.X + this.C * vec.Y + this.TX,
+        .Y = this.B * vec.X + this.D * vec.Y + this.TY,
+    };
+}
+
+#endif  // MINO_INLINE_MATH || MINO_MATH_IMPLEMENTATION
+
+#endif  // MathInline_H
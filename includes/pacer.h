@@ -0,0 +1,68 @@
+#ifndef Pacer_H
+#define Pacer_H
+
+#include "types.h"
+
+// `FramePacer` keeps a game loop running at a steady frame rate.
+//
+// Instead of sleeping for however much time is left in the frame (which
+// rounds and drifts), the pacer keeps an absolute deadline for the end of each
+// frame. It sleeps until shortly before that deadline then spins for the last
+// fraction of a millisecond so it wakes up on time without keeping the CPU busy
+// for the whole frame.
+//
+// Call `FramePacerWait` once at the end of every frame.
+typedef struct FramePacer {
+    // `interval` is the target length of a frame in nanoseconds.
+    int64 interval;
+    // `deadline` is the time (from `WindowTimeNano`) the current frame should
+    // end at.
+    int64 deadline;
+    // `spinTime` is how long before the deadline the pacer stops sleeping and
+    // starts spinning. It adapts to how late the system wakes the pacer up.
+    int64 spinTime;
+    int64 lastWake;
+
+    int64 frames;
+    int64 missedFrames;
+    int64 maxError;
+    float64 intervalMean;
+    float64 intervalM2;
+} FramePacer;
+
+// `FramePacerReport` summarizes how accurately a `FramePacer` has been keeping
+// time. All times are in nanoseconds.
+typedef struct FramePacerReport {
+    // `frames` is the number of frames measured.
+    int64 frames;
+    // `missedFrames` is the number of frames that finished so late the pacer
+    // gave up on catching up and started counting from the current time.
+    int64 missedFrames;
+    // `averageInterval` is the average time between frames.
+    float64 averageInterval;
+    // `jitter` is the standard deviation of the time between frames.
+    float64 jitter;
+    // `maxError` is the furthest any frame has been from the target interval.
+    int64 maxError;
+} FramePacerReport;
+
+// `FramePacerInit` sets up `pacer` to target `framesPerSecond` frames every
+// second. The first frame starts counting from when this is called.
+void FramePacerInit(FramePacer* pacer, float64 framesPerSecond);
+
+// `FramePacerWait` waits until the end of the current frame.
+//
+// If the frame took so long that the deadline passed by more than an entire
+// frame, the pacer doesn't try to catch up (which would run several frames
+// back to back) and instead starts the next frame from now.
+void FramePacerWait(FramePacer* pacer);
+
+// `FramePacerGetReport` returns the timing statistics gathered since the pacer
+// was initialized or since the last call to `FramePacerResetReport`.
+FramePacerReport FramePacerGetReport(FramePacer* pacer);
+
+// `FramePacerResetReport` clears the timing statistics without changing the
+// pacer's schedule.
+void FramePacerResetReport(FramePacer* pacer);
+
+#endif  // Pacer_H
@@ -0,0 +1,128 @@
+#ifndef Profiler_H
+#define Profiler_H
+
+#include "framebuffer.h"
+#include "graphics.h"
+#include "types.h"
+
+typedef struct Window Window;
+typedef struct SpriteBatch SpriteBatch;
+
+// `PROFILER_HISTORY` is how many frames a `Profiler` remembers.
+#ifndef PROFILER_HISTORY
+#define PROFILER_HISTORY 240
+#endif  // PROFILER_HISTORY
+
+// `ProfilerFrame` is where the time of a single frame went. All times are in
+// nanoseconds.
+typedef struct ProfilerFrame {
+    // `frameTime` is the time from the start of this frame to the start of
+    // the next one.
+    int64 frameTime;
+    // `workTime` is the time the game spent between `ProfilerBeginFrame` and
+    // `ProfilerEndFrame`.
+    int64 workTime;
+    // `eventTime`, `controllerTime` and `swapTime` are the phases of the
+    // `WindowUpdate` that ended the frame. See `WindowStats`.
+    int64 eventTime;
+    int64 controllerTime;
+    int64 swapTime;
+    // `gpuTime` is the time the GPU took to run the commands sent between
+    // `ProfilerBeginFrame` and `ProfilerEndFrame`. It is -1 if it couldn't be
+    // measured.
+    int64 gpuTime;
+} ProfilerFrame;
+
+// `Profiler` measures where the time of each frame goes, on both the CPU and
+// the GPU, and keeps a rolling history of the last `PROFILER_HISTORY` frames.
+//
+// Call `ProfilerBeginFrame` right after `WindowUpdate` and `ProfilerEndFrame`
+// right before `GraphicsPresent` (or `WindowUpdate` if the game doesn't call
+// it). GPU time is measured with OpenGL timestamp queries. Results
+// are read back two frames later so measuring never waits for the GPU, which
+// means the newest two frames don't have a `gpuTime` yet.
+typedef struct Profiler {
+    // `frames` is a ring of the recorded frames. The newest one is at
+    // `(count - 1) % PROFILER_HISTORY`.
+    ProfilerFrame frames[PROFILER_HISTORY];
+    // `count` is how many frames have been recorded in total.
+    int64 count;
+    // `targetTime` is the frame time the overlay graph is drawn against.
+    int64 targetTime;
+
+    int64 frameStart;
+    int64 workTime;
+
+    // `gpu` is set if the context supports timestamp queries. `queries` holds
+    // the start and end timestamp of the last two frames, and
+    // `queryFrames` the frame each pair measured or -1.
+    bool gpu;
+    uint32 queries[2][2];
+    int64 queryFrames[2];
+
+    // `overlay` and `white` draw the overlay. They are created the first time
+    // `ProfilerDraw` is called.
+    SpriteBatch* overlay;
+    Texture white;
+} Profiler;
+
+// `ProfilerReport` summarizes the frames in a `Profiler`'s history. All times
+// are averages in nanoseconds.
+typedef struct ProfilerReport {
+    // `frames` is the number of frames summarized.
+    int frames;
+    float64 frameTime;
+    // `cpuTime` is the time the CPU was busy with the frame: the game's work,
+    // events and controllers.
+    float64 cpuTime;
+    float64 swapTime;
+    // `gpuTime` only covers frames whose GPU time was measured, and is 0 if
+    // there aren't any.
+    float64 gpuTime;
+    // `maxFrameTime` is the longest frame.
+    int64 maxFrameTime;
+    // `gpuBound` is set when the GPU takes longer than the CPU, so drawing
+    // less would speed frames up but doing less game logic wouldn't.
+    bool gpuBound;
+} ProfilerReport;
+
+// `ProfilerInit` resets `profiler`. `targetTime` is the frame time in
+// nanoseconds the game is aiming for, which the overlay graph draws a line at.
+//
+// GPU time is only measured if the window's OpenGL context is current when
+// this is called.
+void ProfilerInit(Profiler* profiler, int64 targetTime);
+
+// `ProfilerBeginFrame` finishes recording the previous frame, using the
+// phases measured by the `WindowUpdate` that just ran, and starts the next.
+void ProfilerBeginFrame(Profiler* profiler, Window* window);
+
+// `ProfilerEndFrame` marks the end of the game's work for the frame.
+void ProfilerEndFrame(Profiler* profiler);
+
+// `ProfilerGetLast` returns the newest frame that has been recorded, or nil if
+// there are none.
+const ProfilerFrame* ProfilerGetLast(Profiler* profiler);
+
+// `ProfilerGetReport` summarizes every frame in the history.
+ProfilerReport ProfilerGetReport(Profiler* profiler);
+
+// `ProfilerDraw` draws a graph of the frame history inside `area` (in pixels
+// from the top left corner of the viewport) with OpenGL. Each frame is a bar
+// split into game work (blue), controllers (purple), events (yellow) and swap
+// (green), with GPU time marked in red and `targetTime` as a white line.
+//
+// Draw this last in the frame, since it turns on alpha blending and turns off
+// depth testing like `SpriteBatchEnd`. It needs OpenGL 3.3 and returns false
+// without drawing anything otherwise.
+bool ProfilerDraw(Profiler* profiler, Rect area);
+
+// `ProfilerDrawFramebuffer` draws the same graph as `ProfilerDraw` into
+// `framebuffer`.
+void ProfilerDrawFramebuffer(Profiler* profiler, Framebuffer* framebuffer, Rect area);
+
+// `ProfilerClose` frees the GPU resources of `profiler`. The context it was
+// initialized with must be current.
+void ProfilerClose(Profiler* profiler);
+
+#endif  // Profiler_H
@@ -0,0 +1,59 @@
+#ifndef Record_H
+#define Record_H
+
+#include "types.h"
+
+typedef struct Window Window;
+
+// `InputRecording` is an input recording being written to or played back from
+// a file. It is attached to a window with `WindowRecordInput` or
+// `WindowReplayInput`.
+//
+// It is not meant to be interacted with directly.
+typedef struct InputRecording InputRecording;
+
+// `WindowRecordInput` starts writing the input state of `window` to the file
+// at `path` after every call to `WindowUpdate`. This returns false if the file
+// couldn't be created.
+//
+// Each frame only stores what changed since the frame before it (and frames
+// where nothing changed are merged together) so even long sessions produce
+// small files.
+//
+// Recording stops with `WindowStopRecording` or when the window is closed.
+bool WindowRecordInput(Window* window, const char* path);
+
+// `WindowReplayInput` plays back a file written by `WindowRecordInput`. This
+// returns false if the file couldn't be read or isn't an input recording.
+//
+// While replaying, `WindowUpdate` takes input one frame at a time from the
+// recording instead of from the keyboard, mouse and gamepads. Running the same
+// recording always produces the same input on the same frames, which makes
+// it possible to compare how different builds perform on the exact same
+// session.
+//
+// The whole file is read up front so playing it back never touches the disk.
+bool WindowReplayInput(Window* window, const char* path);
+
+// `WindowReplayFinished` returns true once every frame of the recording being
+// replayed has been played back. It also returns true if nothing is being
+// replayed.
+bool WindowReplayFinished(Window* window);
+
+// `WindowStopRecording` stops recording or replaying input and closes the
+// file. It does nothing if neither is happening.
+void WindowStopRecording(Window* window);
+
+// `InputRecordingReplaying` returns true if input for `window` is coming from
+// a recording rather than its devices.
+//
+// This is used internally by the platform implementations.
+bool InputRecordingReplaying(Window* window);
+
+// `InputRecordingUpdate` writes or plays back a single frame of input. It is
+// called once by every `WindowUpdate`.
+//
+// This is used internally by the platform implementations.
+void InputRecordingUpdate(Window* window);
+
+#endif  // Record_H
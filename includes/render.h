@@ -0,0 +1,115 @@
+#ifndef Render_H
+#define Render_H
+
+#include "types.h"
+
+typedef struct Window Window;
+
+// `RenderCommand` is a function recorded into a `RenderThread` to be run on
+// the render thread. `data` is the copy of its arguments made when it was
+// recorded.
+typedef void (*RenderCommand)(void* data);
+
+// `RenderList` is a buffer of recorded commands, each followed by its data.
+//
+// It is not meant to be interacted with directly.
+typedef struct RenderList {
+    byte* commands;
+    int size, capacity;
+    int count;
+} RenderList;
+
+// `RenderThreadStats` describes the last frame the render thread finished.
+// All times are in nanoseconds.
+typedef struct RenderThreadStats {
+    // `commands` is the number of commands that were run.
+    int commands;
+    // `replayTime` is the time spent running them.
+    int64 replayTime;
+    // `swapTime` is the time spent showing the frame afterwards.
+    int64 swapTime;
+    // `waitTime` is the time the game spent in `RenderThreadSubmit` waiting
+    // for the render thread to catch up. If this is often above 0, drawing is
+    // what limits the frame rate.
+    int64 waitTime;
+} RenderThreadStats;
+
+// `RenderThreadNative` is the platform's thread and synchronization.
+//
+// It is not meant to be interacted with directly.
+typedef struct RenderThreadNative RenderThreadNative;
+
+// `RenderThread` runs every OpenGL call of a window on a thread of its own, so
+// the game can simulate the next frame while the last one is drawn.
+//
+// Instead of calling OpenGL directly, the game records commands with
+// `RenderThreadRecord` or `RenderThreadCall` and hands the frame over with
+// `RenderThreadSubmit`. There are two command lists: the game records into
+// one while the render thread runs the other and then presents the frame. If
+// the game gets a whole frame ahead, `RenderThreadSubmit` waits for the
+// render thread to finish.
+//
+// The render thread owns the context, so anything that uses OpenGL (including
+// `GraphicsAddDamage` and `GraphicsSetVirtualResolution`) has to be done
+// from a command until `RenderThreadClose`.
+//
+// Note: This is currently only threaded on Linux, where the window has to be
+// created with `WindowConfig.renderThread`. Elsewhere commands are run on the
+// game thread by `RenderThreadSubmit`.
+typedef struct RenderThread {
+    Window* window;
+    RenderList lists[2];
+    // `recording` is the index of the list the game is recording into.
+    int recording;
+
+    RenderThreadStats stats;
+
+    // `width` and `height` are the viewport the render thread last set.
+    int width, height;
+
+    RenderThreadNative* native;
+} RenderThread;
+
+// `RenderThreadInit` starts a render thread for `window` and moves its OpenGL
+// context to it. `GraphicsInit` has to have been called on this thread first.
+//
+// This returns false if the thread couldn't be started, in which case the
+// context stays current on this thread.
+bool RenderThreadInit(RenderThread* render, Window* window);
+
+// `RenderThreadRecord` records `command` and returns `size` bytes of data to
+// fill in for it, or nil if there's no memory left. The data is only valid
+// until the next command is recorded.
+void* RenderThreadRecord(RenderThread* render, RenderCommand command, int size);
+
+// `RenderThreadCall` records `command` with a copy of the `size` bytes at
+// `data`.
+void RenderThreadCall(RenderThread* render, RenderCommand command, const void* data, int size);
+
+// `RenderThreadSubmit` hands the commands recorded this frame to the render
+// thread, which runs them and then presents the frame.
+void RenderThreadSubmit(RenderThread* render);
+
+// `RenderThreadSync` waits until every submitted frame has been drawn and
+// presented.
+void RenderThreadSync(RenderThread* render);
+
+// `RenderThreadClose` stops the render thread after it has drawn everything
+// submitted, and makes the context current on this thread again. Call this
+// before `GraphicsClose`.
+void RenderThreadClose(RenderThread* render);
+
+// `GraphicsReleaseContext` unbinds the window's context from the calling
+// thread, so another thread can make it current. This returns false if the
+// window can't be drawn to from another thread.
+//
+// This is used internally by `RenderThread`.
+bool GraphicsReleaseContext(Window* window);
+
+// `GraphicsSwapBuffers` shows the frame like `GraphicsPresent` but from any
+// thread, and returns how long it took in nanoseconds.
+//
+// This is used internally by `RenderThread`.
+int64 GraphicsSwapBuffers(Window* window);
+
+#endif  // Render_H
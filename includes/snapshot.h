@@ -0,0 +1,82 @@
+#ifndef Snapshot_H
+#define Snapshot_H
+
+#include "gamepad.h"
+#include "keyboard.h"
+#include "types.h"
+
+typedef struct Window Window;
+
+// `INPUT_SNAPSHOT_GAMEPADS` is the maximum number of gamepads an
+// `InputSnapshot` can hold.
+#ifndef INPUT_SNAPSHOT_GAMEPADS
+#define INPUT_SNAPSHOT_GAMEPADS 8
+#endif  // INPUT_SNAPSHOT_GAMEPADS
+
+// `GamepadSnapshot` is the state of a single gamepad at the time an
+// `InputSnapshot` was taken.
+typedef struct GamepadSnapshot {
+    bool connected;
+    uint32 buttons;
+    float32 axes[GamepadAxis_Count];
+} GamepadSnapshot;
+
+// `InputSnapshot` is a copy of a window's input state at a single point in
+// time.
+typedef struct InputSnapshot {
+    // `time` is when the snapshot was taken, measured with `WindowTimeNano`.
+    int64 time;
+
+    KeySet keyPressed;
+    byte keyMod;
+
+    int mouseX, mouseY;
+    byte mousePressed;
+
+    // `scrollX` and `scrollY` are the total distance scrolled since the window
+    // was created rather than since the last frame.
+    int scrollX, scrollY;
+
+    int width, height;
+
+    // `closed` is set once the user has asked to close the window.
+    bool closed;
+
+    int gamepadCount;
+    GamepadSnapshot gamepads[INPUT_SNAPSHOT_GAMEPADS];
+} InputSnapshot;
+
+// `SnapshotLock` shares an `InputSnapshot` between a thread that writes it and
+// threads that read it without either side ever waiting on a lock.
+//
+// It is a sequence lock: the writer bumps `sequence` to an odd number before
+// writing and back to an even number afterwards. Readers copy the snapshot
+// and retry if the sequence was odd or changed while they were copying.
+typedef struct SnapshotLock {
+    uint32 sequence;
+    uint64 words[(sizeof(InputSnapshot) + sizeof(uint64) - 1) / sizeof(uint64)];
+} SnapshotLock;
+
+// `SnapshotPublish` makes `snapshot` the latest snapshot held by `lock`.
+//
+// Only one thread should publish to a lock.
+void SnapshotPublish(SnapshotLock* lock, const InputSnapshot* snapshot);
+
+// `SnapshotRead` copies the latest snapshot published to `lock` into
+// `snapshot`. This never blocks, though it may retry the copy if a new
+// snapshot is published while it's reading.
+void SnapshotRead(SnapshotLock* lock, InputSnapshot* snapshot);
+
+// `InputSnapshotCapture` copies the current input state of `window` into
+// `snapshot`.
+void InputSnapshotCapture(Window* window, InputSnapshot* snapshot);
+
+// `WindowLatestInput` copies the most recent input state into `snapshot`.
+//
+// When the window was created with an `inputRate`, this returns what the input
+// thread has seen most recently, which may be newer than the state from the
+// last call to `WindowUpdate`. Otherwise it returns the state from the last
+// call to `WindowUpdate`.
+void WindowLatestInput(Window* window, InputSnapshot* snapshot);
+
+#endif  // Snapshot_H
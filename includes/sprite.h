@@ -0,0 +1,113 @@
+#ifndef Sprite_H
+#define Sprite_H
+
+#include "aff3.h"
+#include "graphics.h"
+#include "types.h"
+
+// `SPRITE_BATCH_REGIONS` is how many parts the vertex buffer of a
+// `SpriteBatch` is split into. The GPU can still be drawing from the other
+// parts while the CPU writes into one, so this is how many batches can be in
+// flight at once.
+#ifndef SPRITE_BATCH_REGIONS
+#define SPRITE_BATCH_REGIONS 3
+#endif  // SPRITE_BATCH_REGIONS
+
+// `SpriteQuad` is the four vertices of a queued sprite.
+//
+// It is not meant to be interacted with directly.
+typedef struct SpriteQuad SpriteQuad;
+
+// `SpriteBatchStats` describes the work done by the last `SpriteBatchEnd`.
+typedef struct SpriteBatchStats {
+    int sprites;
+    int drawCalls;
+} SpriteBatchStats;
+
+// `SpriteBatch` draws lots of textured quads (sprites) with very few draw
+// calls.
+//
+// Sprites are queued with `SpriteBatchDraw` and drawn all at once by
+// `SpriteBatchEnd`. They are grouped by texture so every run of sprites that
+// share a texture takes a single draw call. Put as many sprites as possible
+// into a few large textures (a texture atlas) to get the most out of this.
+//
+// Vertices are written straight into a vertex buffer the GPU can read from
+// while it's mapped (a persistently mapped buffer), split into regions that
+// are reused in a ring. Fences keep the CPU from overwriting a region the GPU
+// hasn't finished drawing. Drivers without persistent mapping (before OpenGL
+// 4.4) fall back to replacing (orphaning) the buffer every batch.
+//
+// A batch needs at least OpenGL 3.3.
+typedef struct SpriteBatch {
+    uint32 program;
+    uint32 vertexArray;
+    uint32 vertexBuffer;
+    uint32 indexBuffer;
+    int viewportLocation;
+
+    // `capacity` is the number of sprites that fit in one region of the
+    // vertex buffer.
+    int capacity;
+
+    // `mapped` is the persistently mapped vertex buffer, or nil if the driver
+    // doesn't support it.
+    SpriteQuad* mapped;
+    // `head` is the index of the next quad to write in the vertex buffer.
+    int head;
+    int region;
+    void* fences[SPRITE_BATCH_REGIONS];
+
+    // `quads` holds the sprites queued since `SpriteBatchBegin`, with `keys`
+    // holding the texture (high 32 bits) and queue order (low 32 bits) of
+    // each one to sort them by.
+    SpriteQuad* quads;
+    uint64* keys;
+    uint64* sortBuffer;
+    int count;
+    int queueCapacity;
+
+    float32 width, height;
+
+    SpriteBatchStats stats;
+} SpriteBatch;
+
+// `SpriteBatchInit` creates the GPU resources for a batch. `capacity` is how
+// many sprites can be drawn before the batch has to wait on the GPU; larger
+// batches are still drawn, just with extra draw calls.
+//
+// The window's OpenGL context must be current. This returns false if the
+// context is too old.
+bool SpriteBatchInit(SpriteBatch* batch, int capacity);
+
+// `SpriteBatchBegin` starts a new batch that draws to a target `width` by
+// `height` pixels in size. Coordinates are in pixels with (0, 0) in the top
+// left corner.
+void SpriteBatchBegin(SpriteBatch* batch, int width, int height);
+
+// `SpriteBatchDraw` queues the `source` area of `texture` to be drawn.
+//
+// The sprite starts as a `source.Width` by `source.Height` rectangle with its
+// top left corner at (0, 0) and is then moved by `transform`. Its pixels are
+// multiplied by `color`, so use white to draw the texture as is.
+//
+// Sprites with the same texture are drawn in the order they were queued.
+// Sprites with different textures may be drawn in any order, so use separate
+// batches if they need to overlap in a certain order.
+void SpriteBatchDraw(SpriteBatch* batch, const Texture* texture, Aff3 transform, Rect source, Color color);
+
+// `SpriteBatchDrawMany` queues `count` sprites of `texture`, the same as
+// calling `SpriteBatchDraw` with `transforms[i]`, `sources[i]` and `colors[i]`
+// for each of them. This is faster for lots of sprites since their corners are
+// transformed together with `Aff3TransformQuads`.
+void SpriteBatchDrawMany(SpriteBatch* batch, const Texture* texture, const Aff3* transforms, const Rect* sources, const Color* colors, int count);
+
+// `SpriteBatchEnd` draws every sprite queued since `SpriteBatchBegin`.
+//
+// This turns on alpha blending and turns off depth testing.
+void SpriteBatchEnd(SpriteBatch* batch);
+
+// `SpriteBatchClose` frees the batch and its GPU resources.
+void SpriteBatchClose(SpriteBatch* batch);
+
+#endif  // Sprite_H
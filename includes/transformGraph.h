@@ -0,0 +1,100 @@
+#ifndef TransformGraph_H
+#define TransformGraph_H
+
+#include "aff3.h"
+#include "types.h"
+
+// `TRANSFORM_ROOT` is the parent of nodes that aren't attached to any other.
+#define TRANSFORM_ROOT -1
+
+// `TransformGraph` is a hierarchy of transforms where every node's world
+// matrix is its local matrix followed by its parent's world matrix.
+//
+// Nodes are stored in flat arrays sorted so every parent comes before its
+// children, which lets `TransformGraphUpdate` work out every world matrix in a
+// single pass from the start. Only nodes whose local matrix changed and the
+// nodes below them are recomputed, and the pass starts at the first changed
+// node, so a graph where nothing moved costs next to nothing.
+//
+// Nodes are identified by the id `TransformGraphAdd` returns, which stays the
+// same while nodes are moved around in the arrays. Ids of removed nodes are
+// reused.
+//
+// The arrays can be read directly for rendering: after `TransformGraphUpdate`,
+// `worlds[i]` is the world matrix of the node with id `ids[i]` for every `i`
+// below `count`.
+typedef struct TransformGraph {
+    // These are indexed by the position of a node in the arrays. `parents` is
+    // the index of each node's parent or `TRANSFORM_ROOT`, and `dirty` is set
+    // for nodes whose local matrix changed since the last update.
+    Aff3* locals;
+    Aff3* worlds;
+    int* parents;
+    int* ids;
+    uint8* dirty;
+    int count, capacity;
+
+    // `indexes` is the position of the node with each id, or -1 if the id
+    // isn't used. `freeIds` are the ids that can be reused, and `nextId` the
+    // lowest id that has never been handed out.
+    int* indexes;
+    int* freeIds;
+    int freeCount;
+    int nextId;
+
+    // `firstDirty` is the lowest index that may be dirty, or at least `count`
+    // if none are. `scratch` is space for reordering the arrays.
+    int firstDirty;
+    int* scratch;
+
+    // `updated` is the number of world matrices recomputed by the last
+    // `TransformGraphUpdate`.
+    int updated;
+} TransformGraph;
+
+// `TransformGraphInit` creates an empty graph with room for `capacity` nodes.
+// The graph grows if more are added.
+//
+// This returns true if the allocation was successful, else it returns false.
+bool TransformGraphInit(TransformGraph* graph, int capacity);
+
+// `TransformGraphAdd` adds a node below `parent` (or `TRANSFORM_ROOT`) and
+// returns its id. Its world matrix is worked out by the next
+// `TransformGraphUpdate`.
+//
+// This returns -1 if `parent` isn't a node or there's no memory left.
+int TransformGraphAdd(TransformGraph* graph, int parent, Aff3 local);
+
+// `TransformGraphRemove` removes `node` along with every node below it.
+void TransformGraphRemove(TransformGraph* graph, int node);
+
+// `TransformGraphSetParent` moves `node`, along with every node below it,
+// under `parent` (or `TRANSFORM_ROOT`).
+//
+// This returns false without changing anything if `node` isn't a node or
+// `parent` is `node` or below it.
+bool TransformGraphSetParent(TransformGraph* graph, int node, int parent);
+
+// `TransformGraphSetLocal` sets the local matrix of `node`, which is relative
+// to its parent.
+void TransformGraphSetLocal(TransformGraph* graph, int node, Aff3 local);
+
+// `TransformGraphGetLocal` returns the local matrix of `node`.
+Aff3 TransformGraphGetLocal(const TransformGraph* graph, int node);
+
+// `TransformGraphGetWorld` returns the world matrix of `node` as of the last
+// `TransformGraphUpdate`.
+Aff3 TransformGraphGetWorld(const TransformGraph* graph, int node);
+
+// `TransformGraphUpdate` recomputes the world matrix of every node that was
+// added, moved or had its local matrix set since the last update, and of
+// every node below those.
+void TransformGraphUpdate(TransformGraph* graph);
+
+// `TransformGraphClear` removes every node but keeps the graph's memory.
+void TransformGraphClear(TransformGraph* graph);
+
+// `TransformGraphClose` frees the graph.
+void TransformGraphClose(TransformGraph* graph);
+
+#endif  // TransformGraph_H
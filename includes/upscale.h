@@ -0,0 +1,88 @@
+#ifndef Upscale_H
+#define Upscale_H
+
+#include "types.h"
+
+typedef struct Window Window;
+
+// `Upscaling` selects how a virtual resolution is scaled up to fill the
+// window.
+typedef enum PACK_ENUM Upscaling {
+    // `Upscaling_Integer` scales by the largest whole number that fits in the
+    // window, so every pixel becomes the same size square. Whatever doesn't
+    // fit is left as a black border.
+    Upscaling_Integer,
+    // `Upscaling_SharpBilinear` fills as much of the window as the aspect
+    // ratio allows. Pixels stay sharp squares, with only the one screen pixel
+    // wide edges between them blended to hide that they can't all be the
+    // same size.
+    Upscaling_SharpBilinear,
+} Upscaling;
+
+// `Upscaler` is the offscreen target a virtual resolution is drawn into.
+//
+// It is not meant to be interacted with directly.
+typedef struct Upscaler Upscaler;
+
+// `GraphicsSetVirtualResolution` makes the game draw at a fixed `width` by
+// `height` resolution no matter how big the window is. Everything is drawn
+// into an offscreen target which `WindowUpdate` scales up to the window in a
+// single pass before showing it.
+//
+// Drawing at a low resolution saves a lot of work on high resolution screens,
+// and keeps pixel art crisp. The viewport is set to the virtual resolution,
+// and window resizes no longer change it. A `width` or `height` of 0 goes back
+// to drawing to the window directly.
+//
+// This needs at least OpenGL 3.3 and returns false if the target couldn't be
+// created.
+bool GraphicsSetVirtualResolution(Window* window, int width, int height, Upscaling upscaling);
+
+// `GraphicsGetFramebuffer` returns the OpenGL framebuffer that draws to the
+// window, which is the virtual resolution target if there is one or 0
+// otherwise. Bind this instead of 0 after drawing to your own framebuffers.
+uint32 GraphicsGetFramebuffer(Window* window);
+
+// `GraphicsSetDynamicResolution` lowers the resolution of the virtual
+// resolution target whenever the GPU can't keep up, and raises it again once
+// there's time to spare. It needs a virtual resolution to already be set and
+// returns false otherwise.
+//
+// How long the GPU spends drawing each frame is measured with timer queries,
+// and the render scale (the fraction of the virtual resolution's width and
+// height that is drawn) is adjusted between `minScale` and `maxScale` to keep
+// it under `targetTime` nanoseconds. The drawn area is always scaled up to
+// the same size in the window, so only the sharpness changes. `maxScale` is
+// capped at 1, and `minScale` has to be above 0 and at most `maxScale`.
+//
+// Leave some room between `targetTime` and the refresh interval, since it
+// doesn't include the time spent scaling up. A `targetTime` of 0 turns this
+// off and goes back to drawing at the full virtual resolution.
+//
+// Each frame the viewport is set to the render size (see
+// `GraphicsGetRenderSize`), so games that set their own viewport need to use
+// that size. The game can't use `GL_TIME_ELAPSED` queries of its own while
+// this is on since they can't be nested.
+bool GraphicsSetDynamicResolution(Window* window, float32 minScale, float32 maxScale, int64 targetTime);
+
+// `GraphicsGetRenderScale` returns the current render scale, or 1 when dynamic
+// resolution is off.
+float32 GraphicsGetRenderScale(Window* window);
+
+// `GraphicsGetRenderSize` returns the size in pixels of the area being drawn to
+// this frame. Without a virtual resolution, this is the size of the window.
+void GraphicsGetRenderSize(Window* window, int* width, int* height);
+
+// `UpscalerPresent` scales the virtual resolution target up to the window,
+// right before buffers are swapped.
+//
+// This is used internally by the platform implementations.
+void UpscalerPresent(Window* window);
+
+// `UpscalerClose` frees the virtual resolution target. `GraphicsClose` calls
+// this while the context still exists.
+//
+// This is used internally by the platform implementations.
+void UpscalerClose(Window* window);
+
+#endif  // Upscale_H
@@ -65,4 +65,19 @@ float32 clamp(float32 value, float32 min, float32 max);
 
 bool hasPrefix(const char* text, const char* prefix);
 
+// `avx2Kernel` marks a function that uses AVX2. It's only defined when
+// compiling for x86 with GCC or Clang, which can build AVX2 code whatever CPU
+// the rest of the program is compiled for. The function must then only be
+// called after `__builtin_cpu_supports("avx2")` says the CPU running the game
+// supports it.
+//
+// Functions that work on arrays are split into kernels that each take the
+// index to start at and return the index they stopped at. The widest kernel
+// the CPU supports goes first, and the narrower ones finish what's left over.
+// Every kernel does the same float operations in the same order as the scalar
+// code, so they all give the same results.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define avx2Kernel __attribute__((target("avx2")))
+#endif
+
 #endif  // Utils_H
\ No newline at end of file
@@ -6,6 +6,16 @@
 #include "consts.h"
 #include "types.h"
 
+// `MATH_API` comes before every `Vec2` and `Aff3` function. If
+// `MINO_INLINE_MATH` is defined, they're all `static inline` and defined in
+// `mathInline.h` so they can be inlined into the game's code. Otherwise
+// they're normal functions.
+#if defined(MINO_INLINE_MATH)
+#define MATH_API static inline
+#else
+#define MATH_API
+#endif
+
 // `Vec2` implements a vector/point in 2D space.
 //
 // Note: None of the `Vec2` functions modify the `Vec2`. Instead if returns a
@@ -16,13 +26,56 @@ typedef struct Vec2 {
 
 typedef struct Aff3 Aff3;
 
+// `Vec2Add` returns the sum of `this` and `vec`.
+MATH_API Vec2 Vec2Add(Vec2 this, Vec2 vec);
+
+// `Vec2Sub` returns `vec` subtracted from `this`.
+MATH_API Vec2 Vec2Sub(Vec2 this, Vec2 vec);
+
+// `Vec2Scale` returns `this` multiplied by `scale`.
+MATH_API Vec2 Vec2Scale(Vec2 this, float32 scale);
+
+// `Vec2Multiply` returns `this` and `vec` multiplied component by component.
+MATH_API Vec2 Vec2Multiply(Vec2 this, Vec2 vec);
+
+// `Vec2Negate` returns `this` pointing the opposite way.
+MATH_API Vec2 Vec2Negate(Vec2 this);
+
+// `Vec2Dot` returns the dot product of `this` and `vec`.
+MATH_API float32 Vec2Dot(Vec2 this, Vec2 vec);
+
+// `Vec2Cross` returns the Z component of the cross product of `this` and `vec`
+// as if they were 3D vectors. It is positive if `vec` points clockwise from
+// `this` (with Y pointing down).
+MATH_API float32 Vec2Cross(Vec2 this, Vec2 vec);
+
+// `Vec2LengthSquared` returns the square of the length of `this`, which is
+// cheaper than `Vec2Length` for comparing lengths.
+MATH_API float32 Vec2LengthSquared(Vec2 this);
+
+// `Vec2Length` returns the length of `this`.
+MATH_API float32 Vec2Length(Vec2 this);
+
+// `Vec2Distance` returns the distance between `this` and `vec`.
+MATH_API float32 Vec2Distance(Vec2 this, Vec2 vec);
+
+// `Vec2Normalize` returns `this` scaled to a length of 1, or (0, 0) if it has
+// no length.
+MATH_API Vec2 Vec2Normalize(Vec2 this);
+
+// `Vec2Lerp` returns the point `t` of the way from `this` to `vec`.
+MATH_API Vec2 Vec2Lerp(Vec2 this, Vec2 vec, float32 t);
+
 // `Vec2TransformAff3` applies the matrix's transformations to the `Vec2`.
 //
 // This applies all transformations applied the the matrix onto this `Vec2`
-Vec2 Vec2TransformAff3(Vec2 this, Aff3 aff3);
+MATH_API Vec2 Vec2TransformAff3(Vec2 this, Aff3 aff3);
 
 // `Vec2Rotate` rotates the `Vec2` around the specified pivot point by the
 // `angle` in degrees.
-Vec2 Vec2Rotate(Vec2 this, Vec2 pivot, float32 angle);
+MATH_API Vec2 Vec2Rotate(Vec2 this, Vec2 pivot, float32 angle);
+
+// `aff3.h` brings in the function bodies when they're inline.
+#include "aff3.h"
 
-#endif  // Vec2_H
\ No newline at end of file
+#endif  // Vec2_H
@@ -1,9 +1,14 @@
 #ifndef Window_H
 #define Window_H
 
+#include "event.h"
 #include "gamepad.h"
+#include "graphics.h"
 #include "keyboard.h"
+#include "record.h"
+#include "render.h"
 #include "types.h"
+#include "upscale.h"
 #include "list.h"
 
 // `WindowNative` is the platforms native implementation of a window.
@@ -15,13 +20,73 @@ typedef struct WindowNative WindowNative;
 typedef struct WindowConfig {
     const char* title;
     const int width, height;
+
+    // `graphics` specifies the OpenGL context created by `GraphicsInit`.
+    const GraphicsConfig graphics;
+
+    // `inputRate` is how many times a second input is checked when it's
+    // handled on its own thread. If this is 0 (the default), input is handled
+    // by `WindowUpdate` instead.
+    //
+    // Handling input on a separate thread means the latest input is available
+    // at any time through `WindowLatestInput` and `WindowUpdate` rather than
+    // only as often as the game updates, which matters most for games that
+    // run at low frame rates.
+    //
+    // Note: This is currently only supported on Linux and is ignored on other
+    // platforms.
+    const int inputRate;
+
+    // `renderThread` lets the OpenGL context be moved to a `RenderThread`.
+    //
+    // Note: This is only needed on Linux, where it makes Xlib safe to call
+    // from several threads.
+    const bool renderThread;
+
+    // `headless` creates a window without anything on screen and without
+    // reading any input devices. Graphics are drawn offscreen (on Linux this
+    // uses EGL, which works without a display server) and input comes from
+    // `inputScript` instead.
+    //
+    // This is useful for running benchmarks and automated tests on machines
+    // that don't have a display.
+    const bool headless;
+
+    // `inputScript` is the input fed to a headless window. It may be nil.
+    const InputScript* inputScript;
 } WindowConfig;
 
+// `WindowStats` records how much work the last call to `WindowUpdate` did.
+//
+// This is useful to check that housekeeping, like watching for gamepads being
+// plugged in, isn't taking time away from your game.
+typedef struct WindowStats {
+    // `hotplugEvents` is the number of device connect and disconnect events
+    // that were handled.
+    int hotplugEvents;
+    // `hotplugTime` is the time in nanoseconds spent checking for and handling
+    // device connects and disconnects.
+    //
+    // Note: This is currently only tracked on Linux.
+    int64 hotplugTime;
+
+    // `eventTime` is the time in nanoseconds spent reading and handling
+    // window and input events.
+    int64 eventTime;
+    // `controllerTime` is the time in nanoseconds spent reading gamepads,
+    // including `hotplugTime`.
+    int64 controllerTime;
+    // `swapTime` is the time in nanoseconds spent showing the frame. This
+    // includes scaling up a virtual resolution and, with vsync on, waiting
+    // for the display.
+    int64 swapTime;
+} WindowStats;
+
 // `Window` is the primary way to draw content to the screen and process user
 // input.
 typedef struct Window {
-    bool keyPressed[Key_Count];
-    bool pKeyPressed[Key_Count];
+    KeySet keyPressed;
+    KeySet pKeyPressed;
     byte KeyMod;
     rune keyChar;
 
@@ -38,6 +103,24 @@ typedef struct Window {
 
     GamepadList gamepads;
 
+    // `events` holds the input events received by the last call to
+    // `WindowUpdate`. See `WindowPollEvent`.
+    InputQueue events;
+
+    WindowStats stats;
+
+    // `recording` is set while input is being recorded or replayed. See
+    // `WindowRecordInput` and `WindowReplayInput`.
+    InputRecording* recording;
+
+    // `upscaler` is set while drawing at a virtual resolution. See
+    // `GraphicsSetVirtualResolution`.
+    Upscaler* upscaler;
+
+    // `renderThread` is set while a `RenderThread` owns the OpenGL context,
+    // which then presents frames instead of `WindowUpdate`.
+    RenderThread* renderThread;
+
     WindowNative* native;
 } Window;
 
@@ -49,8 +132,24 @@ bool WindowInit(Window* window, WindowConfig config);
 
 // `WindowUpdate` processes user input as well as updates the content of the
 // window with previous graphic draw calls. This should be called every frame.
+//
+// If the frame wasn't already shown with `GraphicsPresent`, it's shown first
+// and input is read afterwards.
 bool WindowUpdate(Window* window);
 
+// `WindowWaitEvents` works like `WindowUpdate` except it first sleeps until
+// there is input to process or `timeout` nanoseconds have passed, whichever
+// comes first. A negative `timeout` waits until input arrives no matter how
+// long it takes.
+//
+// This is useful for tools and menus that only need to redraw when the user
+// does something. Instead of running as fast as possible, the program sleeps
+// and uses barely any CPU until it is needed.
+//
+// Note: On Windows, XInput gamepads can't wake up the window so you may want
+// to pass a timeout if you need to react to gamepad input.
+bool WindowWaitEvents(Window* window, int64 timeout);
+
 // `WindowClose` cleans up this window.
 //
 // It should be called when you are finished using this `Window`.
@@ -60,8 +159,17 @@ void WindowClose(Window* window);
 //
 // You can take readings of time from the start and end of a frame to figure out
 // how long that frame has taken to finish.
+//
+// This reads the same monotonic clock as `WindowTimeNano` so it won't jump
+// when the system clock gets adjusted.
 int64 WindowTime();
 
+// `WindowTimeNano` nanoseconds since an arbitrary (but fixed) point in time.
+//
+// Unlike the wall clock, this never jumps forwards or backwards when the system
+// time is changed, which makes it suitable for measuring and scheduling frames.
+int64 WindowTimeNano();
+
 // `WindowSleep` sleeps for the specified number of milliseconds.
 //
 // Currently, `WindowUpdate` does not wait until the next frame to return.
@@ -69,6 +177,16 @@ int64 WindowTime();
 // computer's resources. Finding the correct amount of time to sleep and calling
 // this function can help prevent the computer from doing extra unnecessary
 // work by sleeping.
+//
+// See also `FramePacer` which handles this for you.
 void WindowSleep(int64 milliseconds);
 
+// `WindowSleepUntil` sleeps until `WindowTimeNano` reaches `deadline`.
+//
+// Sleeping until an absolute time instead of for a duration means time spent
+// doing work before calling this doesn't push the wake up time back. The
+// system may still wake up a little late so use `FramePacer` if you need more
+// accuracy.
+void WindowSleepUntil(int64 deadline);
+
 #endif  // Window_H
\ No newline at end of file
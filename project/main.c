@@ -4,19 +4,27 @@
 #include "aff3.h"
 #include "audio.h"
 #include "consts.h"
+#include "framebuffer.h"
 #include "gamepad.h"
 #include "graphics.h"
 #include "keyboard.h"
 #include "mouse.h"
+#include "pacer.h"
 #include "synth.h"
 #include "types.h"
 #include "utils.h"
 #include "window.h"
 
+#if !defined(MINO_NO_GL)
 #include <GL/gl.h>
+#endif
 
 Window window;
 Audio audio;
+FramePacer pacer;
+#if defined(MINO_NO_GL)
+Framebuffer framebuffer;
+#endif
 
 typedef struct Synth {
     Phasor phasor;
@@ -37,7 +45,20 @@ Synth synth = {
 
 int main(void) {
     println("Starting game");
-    if (WindowInit(&window, (WindowConfig){"Mino Demo Game Window", 800, 600}) == false) {
+    WindowConfig config = {
+        .title = "Mino Demo Game Window",
+        .width = 800,
+        .height = 600,
+        // The demo draws with `glBegin` so it needs a compatibility context.
+        .graphics = {
+            .profile = GraphicsProfile_Compatibility,
+            .samples = 4,
+#if defined(NDEBUG)
+            .noError = true,
+#endif
+        },
+    };
+    if (WindowInit(&window, config) == false) {
         println("Could not open the window");
         return 1;
     }
@@ -46,6 +67,14 @@ int main(void) {
     //     WindowClose(&window);
     //     return 1;
     // }
+#if defined(MINO_NO_GL)
+    if (FramebufferInit(&framebuffer, &window) == false) {
+        println("Could not open the framebuffer");
+        WindowClose(&window);
+        return 1;
+    }
+    bool vsync = false;
+#else
     if (GraphicsInit(&window) == false) {
         println("Could not open Graphics");
         AudioClose(&audio);
@@ -53,9 +82,16 @@ int main(void) {
         return 1;
     }
 
-    while (WindowUpdate(&window)) {
-        int64 begin = WindowTime();
+    // Let vsync pace the game when it's available (preferring adaptive vsync so
+    // late frames don't stutter) and fall back to sleeping otherwise. Only
+    // trust vsync if an interval was actually applied, since the driver may
+    // not let us change it at all.
+    bool vsync = GraphicsSetSwapInterval(&window, -1) || GraphicsSetSwapInterval(&window, 1);
+    println("Swap interval: %d", GraphicsGetSwapInterval(&window));
+#endif
 
+    FramePacerInit(&pacer, 60);
+    while (WindowUpdate(&window)) {
         // int availableAudio = AudioAvailable(&audio);
         // if (availableAudio > 0) {
         //     float32 buffer[AUDIO_BUFFER_SIZE];
@@ -80,13 +116,14 @@ int main(void) {
 
         if (window.scrollX != 0 || window.scrollY != 0) println("Scroll = { X: %d, Y: %d }", window.scrollX, window.scrollY);
 
-        for (int i = 0; i < Key_Count; i++) {
-            if (KeyJustPressed(&window, i)) {
-                println("Key %d just pressed", i);
-            }
-            if (KeyJustReleased(&window, i)) {
-                println("Key %d just released", i);
-            }
+        Key key;
+        KeySet keys = KeysJustPressed(&window);
+        while (KeySetNext(&keys, &key)) {
+            println("Key %d just pressed", key);
+        }
+        keys = KeysJustReleased(&window);
+        while (KeySetNext(&keys, &key)) {
+            println("Key %d just released", key);
         }
         rune c = KeyGetChar(&window);
         if (c) println("You typed: %c", c);
@@ -102,6 +139,11 @@ int main(void) {
                 GamepadAxisValue(gamepad, GamepadAxis_RightTrigger));
         }
 
+#if defined(MINO_NO_GL)
+        FramebufferFill(&framebuffer, 0, 0, framebuffer.width, framebuffer.height, (Color){0x00, 0x00, 0x00, 0xFF});
+        FramebufferFill(&framebuffer, window.mouseX - 16, window.mouseY - 16, 32, 32, (Color){0xFF, 0x00, 0x00, 0xFF});
+        FramebufferPresent(&framebuffer);
+#else
         GraphicsMakeCurrent(&window);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glBegin(GL_TRIANGLES);
@@ -116,13 +158,23 @@ int main(void) {
             glVertex3f(-1, -1, 0);
         }
         glEnd();
+        GraphicsPresent(&window);
+#endif
 
-        int64 now = WindowTime();
-        if (now - begin < 1000 / 60 && 1000 / 60 - (now - begin) > 0) {
-            WindowSleep(1000 / 60 - (now - begin));
-        }
+        if (vsync == false) FramePacerWait(&pacer);
     }
+    FramePacerReport report = FramePacerGetReport(&pacer);
+    if (vsync == false) println("Frames: %lld, Missed: %lld, Average: %.3fms, Jitter: %.3fms, Max Error: %.3fms",
+        report.frames,
+        report.missedFrames,
+        report.averageInterval / 1000000,
+        report.jitter / 1000000,
+        report.maxError / 1000000.0);
+#if defined(MINO_NO_GL)
+    FramebufferClose(&framebuffer);
+#else
     GraphicsClose(&window);
+#endif
     // AudioClose(&audio);
     WindowClose(&window);
     return 0;
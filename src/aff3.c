@@ -1,3 +1,7 @@
+// The `Vec2` and `Aff3` functions themselves are in `mathInline.h`, and are
+// compiled here unless they're inline.
+#define MINO_MATH_IMPLEMENTATION
+
 #include <math.h>
 
 #include "aff3.h"
@@ -5,78 +9,219 @@
 #include "types.h"
 #include "utils.h"
 
-static const Aff3 aff3 = (Aff3){.A = 1, .B = 0, .TX = 0, .C = 0, .D = 1, .TY = 0};
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(avx2Kernel)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__)
+
+static int transformPointsSSE2(Aff3 this, const Vec2 *points, Vec2 *out, int i, int count) {
+    // Two interleaved points are transformed by multiplying them by
+    // [A, D, A, D] and with X and Y swapped by [C, B, C, B].
+    const __m128 ad = _mm_setr_ps(this.A, this.D, this.A, this.D);
+    const __m128 cb = _mm_setr_ps(this.C, this.B, this.C, this.B);
+    const __m128 translation = _mm_setr_ps(this.TX, this.TY, this.TX, this.TY);
+    for (; i + 2 <= count; i += 2) {
+        __m128 xy = _mm_loadu_ps(&points[i].X);
+        __m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xy, ad), _mm_mul_ps(yx, cb)), translation);
+        _mm_storeu_ps(&out[i].X, result);
+    }
+    return i;
+}
 
-extern inline Aff3 Aff3Identity() {
-    return aff3;
+static int transformSoASSE2(Aff3 this, const float32 *xs, const float32 *ys, float32 *outXs, float32 *outYs, int i, int count) {
+    const __m128 a = _mm_set1_ps(this.A), b = _mm_set1_ps(this.B);
+    const __m128 c = _mm_set1_ps(this.C), d = _mm_set1_ps(this.D);
+    const __m128 tx = _mm_set1_ps(this.TX), ty = _mm_set1_ps(this.TY);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(&xs[i]);
+        __m128 y = _mm_loadu_ps(&ys[i]);
+        _mm_storeu_ps(&outXs[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(c, y)), tx));
+        _mm_storeu_ps(&outYs[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, x), _mm_mul_ps(d, y)), ty));
+    }
+    return i;
 }
 
-Aff3 Aff3Concat(Aff3 this, Aff3 aff3) {
-    return (Aff3){
-        .A = this.A * aff3.A + this.B * aff3.C,
-        .B = this.A * aff3.B + this.B * aff3.D,
-        .C = this.C * aff3.A + this.D * aff3.C,
-        .D = this.C * aff3.B + this.D * aff3.D,
-        .TX = this.TX * aff3.A + this.TY * aff3.C + aff3.TX,
-        .TY = this.TX * aff3.B + this.TY * aff3.D + aff3.TY,
-    };
+static int transformQuadsSSE2(const Aff3 *transforms, const Vec2 *sizes, Vec2 *corners, int i, int count) {
+    for (; i < count; i++) {
+        const Aff3 *transform = &transforms[i];
+        __m128 size = _mm_setr_ps(sizes[i].X, sizes[i].X, sizes[i].Y, sizes[i].Y);
+        __m128 origin = _mm_setr_ps(transform->TX, transform->TY, transform->TX, transform->TY);
+        // `edges` is the top edge followed by the left edge.
+        __m128 edges = _mm_mul_ps(_mm_loadu_ps(&transform->A), size);
+
+        __m128 top = _mm_add_ps(origin, _mm_movelh_ps(_mm_setzero_ps(), edges));
+        __m128 bottom = _mm_add_ps(top, _mm_movehl_ps(edges, edges));
+        _mm_storeu_ps(&corners[i * 4].X, top);
+        _mm_storeu_ps(&corners[i * 4 + 2].X, _mm_shuffle_ps(bottom, bottom, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+    return i;
 }
 
-Aff3 Aff3Invert(Aff3 this) {
-    float32 norm = this.A * this.D - this.B * this.C;
-    if (norm == 0) {
-        return (Aff3){.A = 0, .B = 0, .C = 0, .D = 0, .TX = -this.TX, .TY = -this.TY};
+static int concatSSE2(const Aff3 *this, const Aff3 *aff3, Aff3 *out, int i, int count) {
+    for (; i < count; i++) {
+        __m128 left = _mm_loadu_ps(&this[i].A);
+        __m128 right = _mm_loadu_ps(&aff3[i].A);
+        __m128 rightTop = _mm_movelh_ps(right, right);
+        __m128 rightBottom = _mm_movehl_ps(right, right);
+
+        __m128 linear = _mm_add_ps(
+            _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(2, 2, 0, 0)), rightTop),
+            _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(3, 3, 1, 1)), rightBottom));
+        __m128 translation = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(this[i].TX), rightTop), _mm_mul_ps(_mm_set1_ps(this[i].TY), rightBottom)),
+            _mm_setr_ps(aff3[i].TX, aff3[i].TY, 0, 0));
+
+        _mm_storeu_ps(&out[i].A, linear);
+        _mm_storel_pi((__m64 *)&out[i].TX, translation);
     }
-    return (Aff3){
-        .A = this.D * norm,
-        .B = this.B * -norm,
-        .C = this.C * -norm,
-        .D = this.D * norm,
-        .TX = -this.A * this.TX - this.C * this.TY,
-        .TY = -this.B * this.TX - this.D * this.TY,
-    };
+    return i;
 }
 
-Aff3 Aff3Rotate(Aff3 this, float32 angle) {
-    angle *= TO_RAD;
-    float32 sin = sinf(angle), cos = cosf(angle);
-    return (Aff3){
-        .A = this.A * cos - this.B * sin,
-        .B = this.A * sin + this.B * cos,
-        .C = this.C * cos - this.D * sin,
-        .D = this.C * sin + this.D * cos,
-        .TX = -this.A * this.TX - this.C * this.TY,
-        .TY = -this.B * this.TX - this.D * this.TY,
-    };
+#endif  // __SSE2__
+
+#if defined(avx2Kernel)
+
+static avx2Kernel int transformPointsAVX2(Aff3 this, const Vec2 *points, Vec2 *out, int i, int count) {
+    const __m256 ad = _mm256_setr_ps(this.A, this.D, this.A, this.D, this.A, this.D, this.A, this.D);
+    const __m256 cb = _mm256_setr_ps(this.C, this.B, this.C, this.B, this.C, this.B, this.C, this.B);
+    const __m256 translation = _mm256_setr_ps(this.TX, this.TY, this.TX, this.TY, this.TX, this.TY, this.TX, this.TY);
+    for (; i + 4 <= count; i += 4) {
+        __m256 xy = _mm256_loadu_ps(&points[i].X);
+        __m256 yx = _mm256_permute_ps(xy, _MM_SHUFFLE(2, 3, 0, 1));
+        __m256 result = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xy, ad), _mm256_mul_ps(yx, cb)), translation);
+        _mm256_storeu_ps(&out[i].X, result);
+    }
+    return i;
 }
 
-Aff3 Aff3Scale(Aff3 this, float32 x, float32 y) {
-    return (Aff3){
-        .A = this.A * x,
-        .B = this.B * y,
-        .C = this.C * x,
-        .D = this.D * y,
-        .TX = this.TX * x,
-        .TY = this.TY * y,
-    };
+static avx2Kernel int transformSoAAVX2(Aff3 this, const float32 *xs, const float32 *ys, float32 *outXs, float32 *outYs, int i, int count) {
+    const __m256 a = _mm256_set1_ps(this.A), b = _mm256_set1_ps(this.B);
+    const __m256 c = _mm256_set1_ps(this.C), d = _mm256_set1_ps(this.D);
+    const __m256 tx = _mm256_set1_ps(this.TX), ty = _mm256_set1_ps(this.TY);
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(&xs[i]);
+        __m256 y = _mm256_loadu_ps(&ys[i]);
+        _mm256_storeu_ps(&outXs[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, x), _mm256_mul_ps(c, y)), tx));
+        _mm256_storeu_ps(&outYs[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, x), _mm256_mul_ps(d, y)), ty));
+    }
+    return i;
 }
 
-Aff3 Aff3Translate(Aff3 this, float32 x, float32 y) {
-    return (Aff3){
-        .A = this.A,
-        .B = this.B,
-        .C = this.C,
-        .D = this.D,
-        .TX = this.TX + x,
-        .TY = this.TX + y,
-    };
+// `transformQuadsAVX2` does two quads at a time, one in each 128 bit lane, the
+// same way as `transformQuadsSSE2`.
+static avx2Kernel int transformQuadsAVX2(const Aff3 *transforms, const Vec2 *sizes, Vec2 *corners, int i, int count) {
+    for (; i + 2 <= count; i += 2) {
+        const Aff3 *first = &transforms[i], *second = &transforms[i + 1];
+        __m256 size = _mm256_setr_ps(
+            sizes[i].X, sizes[i].X, sizes[i].Y, sizes[i].Y,
+            sizes[i + 1].X, sizes[i + 1].X, sizes[i + 1].Y, sizes[i + 1].Y);
+        __m256 origin = _mm256_setr_ps(
+            first->TX, first->TY, first->TX, first->TY,
+            second->TX, second->TY, second->TX, second->TY);
+        __m256 linear = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&first->A)), _mm_loadu_ps(&second->A), 1);
+        __m256 edges = _mm256_mul_ps(linear, size);
+
+        __m256 top = _mm256_add_ps(origin, _mm256_shuffle_ps(_mm256_setzero_ps(), edges, _MM_SHUFFLE(1, 0, 1, 0)));
+        __m256 bottom = _mm256_add_ps(top, _mm256_shuffle_ps(edges, edges, _MM_SHUFFLE(3, 2, 3, 2)));
+        bottom = _mm256_permute_ps(bottom, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm256_storeu_ps(&corners[i * 4].X, _mm256_permute2f128_ps(top, bottom, 0x20));
+        _mm256_storeu_ps(&corners[i * 4 + 4].X, _mm256_permute2f128_ps(top, bottom, 0x31));
+    }
+    return i;
+}
+
+// `concatAVX2` does two pairs of matrices at a time, one in each 128 bit lane,
+// the same way as `concatSSE2`.
+static avx2Kernel int concatAVX2(const Aff3 *this, const Aff3 *aff3, Aff3 *out, int i, int count) {
+    for (; i + 2 <= count; i += 2) {
+        __m256 left = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&this[i].A)), _mm_loadu_ps(&this[i + 1].A), 1);
+        __m256 right = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&aff3[i].A)), _mm_loadu_ps(&aff3[i + 1].A), 1);
+        __m256 rightTop = _mm256_shuffle_ps(right, right, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 rightBottom = _mm256_shuffle_ps(right, right, _MM_SHUFFLE(3, 2, 3, 2));
+
+        __m256 linear = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(2, 2, 0, 0)), rightTop),
+            _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(3, 3, 1, 1)), rightBottom));
+        __m256 tx = _mm256_setr_m128(_mm_set1_ps(this[i].TX), _mm_set1_ps(this[i + 1].TX));
+        __m256 ty = _mm256_setr_m128(_mm_set1_ps(this[i].TY), _mm_set1_ps(this[i + 1].TY));
+        __m256 translation = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(tx, rightTop), _mm256_mul_ps(ty, rightBottom)),
+            _mm256_setr_ps(aff3[i].TX, aff3[i].TY, 0, 0, aff3[i + 1].TX, aff3[i + 1].TY, 0, 0));
+
+        _mm_storeu_ps(&out[i].A, _mm256_castps256_ps128(linear));
+        _mm_storel_pi((__m64 *)&out[i].TX, _mm256_castps256_ps128(translation));
+        _mm_storeu_ps(&out[i + 1].A, _mm256_extractf128_ps(linear, 1));
+        _mm_storel_pi((__m64 *)&out[i + 1].TX, _mm256_extractf128_ps(translation, 1));
+    }
+    return i;
+}
+
+#endif  // avx2Kernel
+
+void Aff3TransformVec2Array(Aff3 this, const Vec2 *points, Vec2 *out, int count) {
+    int i = 0;
+#if defined(avx2Kernel)
+    if (__builtin_cpu_supports("avx2")) i = transformPointsAVX2(this, points, out, i, count);
+#endif
+#if defined(__SSE2__)
+    i = transformPointsSSE2(this, points, out, i, count);
+#endif
+    for (; i < count; i++) out[i] = Aff3TransformVec2(this, points[i]);
+}
+
+void Aff3TransformVec2SoA(Aff3 this, const float32 *xs, const float32 *ys, float32 *outXs, float32 *outYs, int count) {
+    int i = 0;
+#if defined(avx2Kernel)
+    if (__builtin_cpu_supports("avx2")) i = transformSoAAVX2(this, xs, ys, outXs, outYs, i, count);
+#endif
+#if defined(__SSE2__)
+    i = transformSoASSE2(this, xs, ys, outXs, outYs, i, count);
+#endif
+    for (; i < count; i++) {
+        float32 x = xs[i], y = ys[i];
+        outXs[i] = this.A * x + this.C * y + this.TX;
+        outYs[i] = this.B * x + this.D * y + this.TY;
+    }
+}
+
+void Aff3TransformQuads(const Aff3 *transforms, const Vec2 *sizes, Vec2 *corners, int count) {
+    int i = 0;
+#if defined(avx2Kernel)
+    if (__builtin_cpu_supports("avx2")) i = transformQuadsAVX2(transforms, sizes, corners, i, count);
+#endif
+#if defined(__SSE2__)
+    i = transformQuadsSSE2(transforms, sizes, corners, i, count);
+#endif
+    for (; i < count; i++) {
+        // The corners are (0, 0), (w, 0), (w, h) and (0, h), so only the
+        // edges along the width and height need to be transformed.
+        Aff3 transform = transforms[i];
+        float32 x = transform.TX, y = transform.TY;
+        float32 wx = transform.A * sizes[i].X, wy = transform.B * sizes[i].X;
+        float32 hx = transform.C * sizes[i].Y, hy = transform.D * sizes[i].Y;
+
+        Vec2 *corner = &corners[i * 4];
+        corner[0] = (Vec2){x, y};
+        corner[1] = (Vec2){x + wx, y + wy};
+        corner[2] = (Vec2){x + wx + hx, y + wy + hy};
+        corner[3] = (Vec2){x + hx, y + hy};
+    }
 }
 
-Vec2 Aff3TransformVec2(Aff3 this, Vec2 vec) {
-    return (Vec2){
-        .X = this.A * vec.X + this.C * vec.Y + this.TX,
-        .Y = this.B * vec.X + this.D * vec.Y + this.TY,
-    };
+void Aff3ConcatArray(const Aff3 *this, const Aff3 *aff3, Aff3 *out, int count) {
+    int i = 0;
+#if defined(avx2Kernel)
+    if (__builtin_cpu_supports("avx2")) i = concatAVX2(this, aff3, out, i, count);
+#endif
+#if defined(__SSE2__)
+    i = concatSSE2(this, aff3, out, i, count);
+#endif
+    for (; i < count; i++) out[i] = Aff3Concat(this[i], aff3[i]);
 }
 
 #ifdef NOPRINT
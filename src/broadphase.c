@@ -0,0 +1,332 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "broadphase.h"
+#include "graphics.h"
+#include "types.h"
+#include "utils.h"
+
+bool BroadphaseInit(Broadphase *broadphase, BroadphaseMode mode, int capacity, int pairCapacity, float32 cellSize) {
+    *broadphase = (Broadphase){.mode = mode, .cellSize = cellSize > 0 ? cellSize : 1};
+    if (capacity < 1) capacity = 1;
+    if (pairCapacity < 1) pairCapacity = 1;
+
+    broadphase->minXs = allocateN(float32, capacity);
+    broadphase->minYs = allocateN(float32, capacity);
+    broadphase->maxXs = allocateN(float32, capacity);
+    broadphase->maxYs = allocateN(float32, capacity);
+    broadphase->used = allocateN(uint8, capacity);
+    broadphase->freeIds = allocateN(int, capacity);
+    broadphase->stamps = allocateN(uint, capacity);
+    broadphase->pairs = allocateN(BroadphasePair, pairCapacity);
+    broadphase->capacity = capacity;
+    broadphase->pairCapacity = pairCapacity;
+    bool allocated = broadphase->minXs && broadphase->minYs && broadphase->maxXs && broadphase->maxYs &&
+                     broadphase->used && broadphase->freeIds && broadphase->stamps && broadphase->pairs;
+
+    if (mode == BroadphaseMode_SweepAndPrune) {
+        broadphase->order = allocateN(int, capacity);
+        broadphase->sortedMins = allocateN(float32, capacity);
+        broadphase->sorted = allocateN(uint8, capacity);
+        allocated = allocated && broadphase->order && broadphase->sortedMins && broadphase->sorted;
+    }
+
+    if (allocated == false) {
+        BroadphaseClose(broadphase);
+        return false;
+    }
+    return true;
+}
+
+static bool growBodies(Broadphase *broadphase) {
+    int capacity = broadphase->capacity * 2;
+    float32 *minXs = reallocateN(broadphase->minXs, float32, capacity);
+    if (minXs == nil) return false;
+    broadphase->minXs = minXs;
+    float32 *minYs = reallocateN(broadphase->minYs, float32, capacity);
+    if (minYs == nil) return false;
+    broadphase->minYs = minYs;
+    float32 *maxXs = reallocateN(broadphase->maxXs, float32, capacity);
+    if (maxXs == nil) return false;
+    broadphase->maxXs = maxXs;
+    float32 *maxYs = reallocateN(broadphase->maxYs, float32, capacity);
+    if (maxYs == nil) return false;
+    broadphase->maxYs = maxYs;
+    uint8 *used = reallocateN(broadphase->used, uint8, capacity);
+    if (used == nil) return false;
+    broadphase->used = used;
+    int *freeIds = reallocateN(broadphase->freeIds, int, capacity);
+    if (freeIds == nil) return false;
+    broadphase->freeIds = freeIds;
+    uint *stamps = reallocateN(broadphase->stamps, uint, capacity);
+    if (stamps == nil) return false;
+    broadphase->stamps = stamps;
+
+    if (broadphase->mode == BroadphaseMode_SweepAndPrune) {
+        int *order = reallocateN(broadphase->order, int, capacity);
+        if (order == nil) return false;
+        broadphase->order = order;
+        float32 *sortedMins = reallocateN(broadphase->sortedMins, float32, capacity);
+        if (sortedMins == nil) return false;
+        broadphase->sortedMins = sortedMins;
+        uint8 *sorted = reallocateN(broadphase->sorted, uint8, capacity);
+        if (sorted == nil) return false;
+        broadphase->sorted = sorted;
+    }
+    broadphase->capacity = capacity;
+    return true;
+}
+
+static void setBox(Broadphase *broadphase, int id, Rect box) {
+    broadphase->minXs[id] = box.X;
+    broadphase->minYs[id] = box.Y;
+    broadphase->maxXs[id] = box.X + box.Width;
+    broadphase->maxYs[id] = box.Y + box.Height;
+}
+
+int BroadphaseAdd(Broadphase *broadphase, Rect box) {
+    int id;
+    if (broadphase->freeCount > 0) {
+        id = broadphase->freeIds[--broadphase->freeCount];
+    } else {
+        if (broadphase->nextId == broadphase->capacity && growBodies(broadphase) == false) return -1;
+        id = broadphase->nextId++;
+        broadphase->stamps[id] = 0;
+        if (broadphase->mode == BroadphaseMode_SweepAndPrune) broadphase->sorted[id] = 0;
+    }
+
+    setBox(broadphase, id, box);
+    broadphase->used[id] = 1;
+    // A removed id is only dropped from the order by the next update, so it
+    // may still be there.
+    if (broadphase->mode == BroadphaseMode_SweepAndPrune && broadphase->sorted[id] == 0) {
+        broadphase->order[broadphase->orderCount] = id;
+        broadphase->sortedMins[broadphase->orderCount] = box.X;
+        broadphase->orderCount++;
+        broadphase->sorted[id] = 1;
+    }
+    return id;
+}
+
+void BroadphaseMove(Broadphase *broadphase, int body, Rect box) {
+    if (body < 0 || body >= broadphase->nextId || broadphase->used[body] == 0) return;
+    setBox(broadphase, body, box);
+}
+
+void BroadphaseRemove(Broadphase *broadphase, int body) {
+    if (body < 0 || body >= broadphase->nextId || broadphase->used[body] == 0) return;
+    broadphase->used[body] = 0;
+    broadphase->freeIds[broadphase->freeCount++] = body;
+}
+
+static inline bool overlaps(const Broadphase *broadphase, int a, int b) {
+    return broadphase->minXs[a] < broadphase->maxXs[b] && broadphase->minXs[b] < broadphase->maxXs[a] &&
+           broadphase->minYs[a] < broadphase->maxYs[b] && broadphase->minYs[b] < broadphase->maxYs[a];
+}
+
+static inline void addPair(Broadphase *broadphase, int a, int b) {
+    if (broadphase->pairCount == broadphase->pairCapacity) {
+        broadphase->stats.missedPairs++;
+        return;
+    }
+    broadphase->pairs[broadphase->pairCount++] = a < b ? (BroadphasePair){a, b} : (BroadphasePair){b, a};
+}
+
+static inline int cellOf(float32 position, float32 inverseCellSize) {
+    return (int)floorf(position * inverseCellSize);
+}
+
+static inline int bucketOf(const Broadphase *broadphase, int cellX, int cellY) {
+    return (int)(((uint)cellX * 73856093u ^ (uint)cellY * 19349663u) & (uint)broadphase->bucketMask);
+}
+
+// `prepareGrid` empties the grid, resizing its table to have about two
+// buckets per body.
+static bool prepareGrid(Broadphase *broadphase) {
+    int buckets = 64;
+    while (buckets < broadphase->nextId * 2) buckets *= 2;
+    if (buckets != broadphase->bucketMask + 1) {
+        int *table = reallocateN(broadphase->buckets, int, buckets);
+        if (table == nil) return false;
+        broadphase->buckets = table;
+        broadphase->bucketMask = buckets - 1;
+    }
+    memset(broadphase->buckets, -1, sizeof(int) * buckets);
+    broadphase->entryCount = 0;
+    return true;
+}
+
+static bool addEntry(Broadphase *broadphase, int bucket, int id, int cellX, int cellY) {
+    if (broadphase->entryCount == broadphase->entryCapacity) {
+        int capacity = broadphase->entryCapacity > 0 ? broadphase->entryCapacity * 2 : broadphase->capacity * 2;
+        BroadphaseEntry *entries = reallocateN(broadphase->entries, BroadphaseEntry, capacity);
+        if (entries == nil) return false;
+        broadphase->entries = entries;
+        broadphase->entryCapacity = capacity;
+    }
+    int entry = broadphase->entryCount++;
+    broadphase->entries[entry] = (BroadphaseEntry){id, broadphase->buckets[bucket], cellX, cellY};
+    broadphase->buckets[bucket] = entry;
+    return true;
+}
+
+// `updateGrid` adds the bodies to the grid one at a time, checking each
+// against the bodies already in the cells it covers. Two boxes can share more
+// than one cell, so a pair is only added by the cell holding the top left
+// corner of where they overlap.
+static void updateGrid(Broadphase *broadphase) {
+    if (prepareGrid(broadphase) == false) return;
+    float32 inverseCellSize = 1 / broadphase->cellSize;
+    const float32 *minXs = broadphase->minXs, *minYs = broadphase->minYs;
+    const float32 *maxXs = broadphase->maxXs, *maxYs = broadphase->maxYs;
+
+    for (int id = 0; id < broadphase->nextId; id++) {
+        if (broadphase->used[id] == 0) continue;
+        broadphase->stats.bodies++;
+        int left = cellOf(minXs[id], inverseCellSize), right = cellOf(maxXs[id], inverseCellSize);
+        int top = cellOf(minYs[id], inverseCellSize), bottom = cellOf(maxYs[id], inverseCellSize);
+
+        for (int cellY = top; cellY <= bottom; cellY++) {
+            for (int cellX = left; cellX <= right; cellX++) {
+                int bucket = bucketOf(broadphase, cellX, cellY);
+                for (int entry = broadphase->buckets[bucket]; entry >= 0; entry = broadphase->entries[entry].next) {
+                    const BroadphaseEntry *other = &broadphase->entries[entry];
+                    if (other->cellX != cellX || other->cellY != cellY) continue;
+                    broadphase->stats.checks++;
+                    if (overlaps(broadphase, id, other->id) == false) continue;
+
+                    float32 cornerX = minXs[id] > minXs[other->id] ? minXs[id] : minXs[other->id];
+                    float32 cornerY = minYs[id] > minYs[other->id] ? minYs[id] : minYs[other->id];
+                    if (cellOf(cornerX, inverseCellSize) != cellX || cellOf(cornerY, inverseCellSize) != cellY) continue;
+                    addPair(broadphase, other->id, id);
+                }
+                if (addEntry(broadphase, bucket, id, cellX, cellY) == false) return;
+            }
+        }
+    }
+}
+
+// `updateSweep` drops removed bodies from the order and sorts it again by the
+// bodies' new left edges with an insertion sort, which is close to linear
+// since bodies only move a little between updates. Then each body is checked
+// against the ones after it until their left edges pass its right edge.
+static void updateSweep(Broadphase *broadphase) {
+    int *order = broadphase->order;
+    float32 *sortedMins = broadphase->sortedMins;
+    int count = 0;
+    for (int i = 0; i < broadphase->orderCount; i++) {
+        int id = order[i];
+        if (broadphase->used[id] == 0) {
+            broadphase->sorted[id] = 0;
+            continue;
+        }
+        order[count] = id;
+        sortedMins[count] = broadphase->minXs[id];
+        count++;
+    }
+    broadphase->orderCount = count;
+    broadphase->stats.bodies = count;
+
+    for (int i = 1; i < count; i++) {
+        int id = order[i];
+        float32 min = sortedMins[i];
+        int j = i - 1;
+        for (; j >= 0 && sortedMins[j] > min; j--) {
+            order[j + 1] = order[j];
+            sortedMins[j + 1] = sortedMins[j];
+        }
+        order[j + 1] = id;
+        sortedMins[j + 1] = min;
+    }
+
+    const float32 *minYs = broadphase->minYs, *maxXs = broadphase->maxXs, *maxYs = broadphase->maxYs;
+    for (int i = 0; i < count; i++) {
+        int id = order[i];
+        float32 right = maxXs[id], top = minYs[id], bottom = maxYs[id];
+        for (int j = i + 1; j < count && sortedMins[j] < right; j++) {
+            int other = order[j];
+            broadphase->stats.checks++;
+            // Their left edges are sorted, so `other` starts before `id`
+            // ends and their horizontal extents overlap unless `other` has
+            // no width.
+            if (minYs[other] < bottom && top < maxYs[other] && sortedMins[i] < maxXs[other]) {
+                addPair(broadphase, id, other);
+            }
+        }
+    }
+}
+
+void BroadphaseUpdate(Broadphase *broadphase) {
+    broadphase->pairCount = 0;
+    broadphase->stats = (BroadphaseStats){0};
+    if (broadphase->mode == BroadphaseMode_Grid) {
+        updateGrid(broadphase);
+    } else {
+        updateSweep(broadphase);
+    }
+}
+
+static inline bool overlapsArea(const Broadphase *broadphase, int id, float32 left, float32 top, float32 right, float32 bottom) {
+    return broadphase->minXs[id] < right && left < broadphase->maxXs[id] &&
+           broadphase->minYs[id] < bottom && top < broadphase->maxYs[id];
+}
+
+int BroadphaseQuery(Broadphase *broadphase, Rect area, int *ids, int capacity) {
+    float32 left = area.X, top = area.Y;
+    float32 right = area.X + area.Width, bottom = area.Y + area.Height;
+    int found = 0;
+    if (capacity <= 0) return 0;
+
+    if (broadphase->mode == BroadphaseMode_SweepAndPrune) {
+        for (int i = 0; i < broadphase->orderCount && broadphase->sortedMins[i] < right && found < capacity; i++) {
+            int id = broadphase->order[i];
+            if (broadphase->used[id] && overlapsArea(broadphase, id, left, top, right, bottom)) ids[found++] = id;
+        }
+        return found;
+    }
+
+    // Bodies can be in more than one of the cells, so each one found is
+    // stamped to skip it the next time.
+    if (broadphase->buckets == nil) return 0;
+    if (++broadphase->stamp == 0) {
+        memset(broadphase->stamps, 0, sizeof(uint) * broadphase->capacity);
+        broadphase->stamp = 1;
+    }
+    float32 inverseCellSize = 1 / broadphase->cellSize;
+    int firstX = cellOf(left, inverseCellSize), lastX = cellOf(right, inverseCellSize);
+    int firstY = cellOf(top, inverseCellSize), lastY = cellOf(bottom, inverseCellSize);
+    for (int cellY = firstY; cellY <= lastY; cellY++) {
+        for (int cellX = firstX; cellX <= lastX; cellX++) {
+            int bucket = bucketOf(broadphase, cellX, cellY);
+            for (int entry = broadphase->buckets[bucket]; entry >= 0; entry = broadphase->entries[entry].next) {
+                const BroadphaseEntry *other = &broadphase->entries[entry];
+                if (other->cellX != cellX || other->cellY != cellY) continue;
+                int id = other->id;
+                if (broadphase->stamps[id] == broadphase->stamp || broadphase->used[id] == 0) continue;
+                broadphase->stamps[id] = broadphase->stamp;
+                if (overlapsArea(broadphase, id, left, top, right, bottom) == false) continue;
+                ids[found++] = id;
+                if (found == capacity) return found;
+            }
+        }
+    }
+    return found;
+}
+
+void BroadphaseClose(Broadphase *broadphase) {
+    free(broadphase->minXs);
+    free(broadphase->minYs);
+    free(broadphase->maxXs);
+    free(broadphase->maxYs);
+    free(broadphase->used);
+    free(broadphase->freeIds);
+    free(broadphase->stamps);
+    free(broadphase->pairs);
+    free(broadphase->buckets);
+    free(broadphase->entries);
+    free(broadphase->order);
+    free(broadphase->sortedMins);
+    free(broadphase->sorted);
+    *broadphase = (Broadphase){0};
+}
@@ -0,0 +1,79 @@
+#include "damage.h"
+#include "types.h"
+
+// `mergeSlack` is how many extra pixels merging two rectangles may cover
+// regardless of their size. Each rectangle costs a request to present, which
+// is worth about this many pixels.
+static const int64 mergeSlack = 32 * 32;
+
+static int64 rectArea(DamageRect rect) {
+    return (int64)rect.width * rect.height;
+}
+
+static DamageRect rectUnion(DamageRect a, DamageRect b) {
+    int left = a.x < b.x ? a.x : b.x;
+    int top = a.y < b.y ? a.y : b.y;
+    int right = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+    int bottom = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return (DamageRect){left, top, right - left, bottom - top};
+}
+
+// `wastedArea` is how many pixels the union of `a` and `b` covers that
+// neither of them do.
+static int64 wastedArea(DamageRect a, DamageRect b) {
+    int left = a.x > b.x ? a.x : b.x;
+    int top = a.y > b.y ? a.y : b.y;
+    int right = a.x + a.width < b.x + b.width ? a.x + a.width : b.x + b.width;
+    int bottom = a.y + a.height < b.y + b.height ? a.y + a.height : b.y + b.height;
+    int64 overlap = right > left && bottom > top ? (int64)(right - left) * (bottom - top) : 0;
+    return rectArea(rectUnion(a, b)) - rectArea(a) - rectArea(b) + overlap;
+}
+
+void DamageAdd(Damage *damage, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    DamageRect rect = {x, y, width, height};
+
+    // Merge with every rectangle that is close enough. The merged rectangle
+    // is bigger, so it may now be worth merging with ones already checked.
+    for (int i = 0; i < damage->count;) {
+        DamageRect other = damage->rects[i];
+        int64 wasted = wastedArea(other, rect);
+        if (wasted <= mergeSlack || wasted * 4 <= rectArea(other) + rectArea(rect)) {
+            rect = rectUnion(other, rect);
+            damage->rects[i] = damage->rects[--damage->count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+
+    if (damage->count < DAMAGE_MAX_RECTS) {
+        damage->rects[damage->count++] = rect;
+        return;
+    }
+
+    // Out of room, so grow whichever rectangle wastes the least.
+    int best = 0;
+    int64 bestWasted = wastedArea(damage->rects[0], rect);
+    for (int i = 1; i < damage->count; i++) {
+        int64 wasted = wastedArea(damage->rects[i], rect);
+        if (wasted < bestWasted) {
+            best = i;
+            bestWasted = wasted;
+        }
+    }
+    damage->rects[best] = rectUnion(damage->rects[best], rect);
+}
+
+bool DamageClip(DamageRect *rect, int width, int height) {
+    int left = rect->x > 0 ? rect->x : 0;
+    int top = rect->y > 0 ? rect->y : 0;
+    int right = rect->x + rect->width < width ? rect->x + rect->width : width;
+    int bottom = rect->y + rect->height < height ? rect->y + rect->height : height;
+    *rect = (DamageRect){left, top, right - left, bottom - top};
+    return rect->width > 0 && rect->height > 0;
+}
+
+void DamageClear(Damage *damage) {
+    damage->count = 0;
+}
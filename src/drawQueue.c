@@ -0,0 +1,236 @@
+#if !defined(MINO_NO_GL)
+
+#include <stdlib.h>
+
+#include "drawQueue.h"
+#include "glLoader.h"
+#include "types.h"
+#include "utils.h"
+
+// A sort key is split into these fields, from the most significant bit down.
+// Programs and textures only use their lowest bits since ids are handed out
+// counting up from 1. Two ids with the same low bits are only grouped less
+// well, the right ones are still bound.
+#define layerShift 56
+#define programShift 46
+#define programMask 0x3FF
+#define textureShift 30
+#define textureMask 0xFFFF
+#define blendShift 25
+#define blendMask 0x1F
+#define depthTestShift 24
+#define depthMask 0xFFFFFF
+
+// `unset` is never a real id, so `DrawState` fields set to it always get set.
+#define unset 0xFFFFFFFF
+
+bool DrawQueueInit(DrawQueue *queue, int capacity) {
+    *queue = (DrawQueue){0};
+    if (GLVersionAtLeast(3, 2) == false) return false;
+    if (capacity < 1) capacity = 1;
+
+    queue->commands = allocateN(DrawCommand, capacity);
+    queue->keys = allocateN(uint64, capacity);
+    queue->order = allocateN(uint32, capacity);
+    queue->sortKeys = allocateN(uint64, capacity);
+    queue->sortOrder = allocateN(uint32, capacity);
+    queue->capacity = capacity;
+    if (queue->commands == nil || queue->keys == nil || queue->order == nil ||
+        queue->sortKeys == nil || queue->sortOrder == nil) {
+        DrawQueueClose(queue);
+        return false;
+    }
+    return true;
+}
+
+uint64 DrawQueueKey(const DrawCommand *command) {
+    float32 depth = command->depth;
+    if (depth < 0) depth = 0;
+    if (depth > 1) depth = 1;
+    return (uint64)command->layer << layerShift |
+           (uint64)(command->program & programMask) << programShift |
+           (uint64)(command->texture & textureMask) << textureShift |
+           (uint64)(command->blend & blendMask) << blendShift |
+           (uint64)(command->depthTest ? 1 : 0) << depthTestShift |
+           (uint64)(depth * depthMask);
+}
+
+static bool growCommands(DrawQueue *queue) {
+    int capacity = queue->capacity * 2;
+    DrawCommand *commands = reallocateN(queue->commands, DrawCommand, capacity);
+    if (commands == nil) return false;
+    queue->commands = commands;
+    uint64 *keys = reallocateN(queue->keys, uint64, capacity);
+    if (keys == nil) return false;
+    queue->keys = keys;
+    uint32 *order = reallocateN(queue->order, uint32, capacity);
+    if (order == nil) return false;
+    queue->order = order;
+    uint64 *sortKeys = reallocateN(queue->sortKeys, uint64, capacity);
+    if (sortKeys == nil) return false;
+    queue->sortKeys = sortKeys;
+    uint32 *sortOrder = reallocateN(queue->sortOrder, uint32, capacity);
+    if (sortOrder == nil) return false;
+    queue->sortOrder = sortOrder;
+    queue->capacity = capacity;
+    return true;
+}
+
+void DrawQueuePush(DrawQueue *queue, DrawCommand command) {
+    if (command.count <= 0) return;
+    if (queue->count == queue->capacity && growCommands(queue) == false) return;
+    queue->commands[queue->count] = command;
+    queue->keys[queue->count] = DrawQueueKey(&command);
+    queue->order[queue->count] = queue->count;
+    queue->count++;
+}
+
+// `sortByKey` sorts the keys of `queue` along with their order using a radix
+// sort, a byte at a time starting from the least significant. Passes where
+// every key has the same byte (like the layer when there's only one) are
+// skipped.
+static void sortByKey(DrawQueue *queue) {
+    int count = queue->count;
+    for (int shift = 0; shift < 64; shift += 8) {
+        int offsets[256] = {0};
+        for (int i = 0; i < count; i++) offsets[(queue->keys[i] >> shift) & 0xFF]++;
+        if (offsets[(queue->keys[0] >> shift) & 0xFF] == count) continue;
+
+        int total = 0;
+        for (int i = 0; i < 256; i++) {
+            int digits = offsets[i];
+            offsets[i] = total;
+            total += digits;
+        }
+        for (int i = 0; i < count; i++) {
+            int index = offsets[(queue->keys[i] >> shift) & 0xFF]++;
+            queue->sortKeys[index] = queue->keys[i];
+            queue->sortOrder[index] = queue->order[i];
+        }
+
+        uint64 *keys = queue->sortKeys;
+        queue->sortKeys = queue->keys;
+        queue->keys = keys;
+        uint32 *order = queue->sortOrder;
+        queue->sortOrder = queue->order;
+        queue->order = order;
+    }
+}
+
+static void setBlend(BlendMode blend) {
+    switch (blend) {
+        case BlendMode_Opaque:
+            glDisable(GL_BLEND);
+            return;
+        case BlendMode_Alpha:
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case BlendMode_Premultiplied:
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case BlendMode_Additive:
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+        case BlendMode_Multiply:
+            glBlendFunc(GL_DST_COLOR, GL_ZERO);
+            break;
+    }
+    glEnable(GL_BLEND);
+}
+
+// `applyState` sets whatever state `command` needs that isn't already set.
+static void applyState(DrawQueue *queue, const DrawCommand *command) {
+    DrawState *state = &queue->state;
+    int changes = 0;
+    if (state->program != command->program) {
+        GL.UseProgram(command->program);
+        state->program = command->program;
+        changes++;
+    }
+    if (state->vertexArray != command->vertexArray) {
+        GL.BindVertexArray(command->vertexArray);
+        state->vertexArray = command->vertexArray;
+        changes++;
+    }
+    if (state->texture != command->texture) {
+        glBindTexture(GL_TEXTURE_2D, command->texture);
+        state->texture = command->texture;
+        changes++;
+    }
+    if (state->blend != (int)command->blend) {
+        setBlend(command->blend);
+        state->blend = command->blend;
+        changes++;
+    }
+    if (state->depthTest != command->depthTest) {
+        if (command->depthTest) {
+            glEnable(GL_DEPTH_TEST);
+        } else {
+            glDisable(GL_DEPTH_TEST);
+        }
+        state->depthTest = command->depthTest;
+        changes++;
+    }
+    queue->stats.stateChanges += changes;
+    queue->stats.skippedChanges += 5 - changes;
+}
+
+// `canMerge` returns true if `next` can be drawn by the same draw call as
+// `command`, which has to be a list of separate primitives rather than a strip
+// or a fan.
+static bool canMerge(const DrawCommand *command, const DrawCommand *next) {
+    if (command->mode != GL_TRIANGLES && command->mode != GL_LINES && command->mode != GL_POINTS) return false;
+    return next->mode == command->mode &&
+           next->program == command->program &&
+           next->vertexArray == command->vertexArray &&
+           next->texture == command->texture &&
+           next->blend == command->blend &&
+           next->depthTest == command->depthTest &&
+           next->indexed == command->indexed &&
+           (command->indexed == false || next->baseVertex == command->baseVertex) &&
+           next->first == command->first + command->count;
+}
+
+void DrawQueueFlush(DrawQueue *queue) {
+    int count = queue->count;
+    queue->stats = (DrawQueueStats){.commands = count};
+    if (count == 0) return;
+    sortByKey(queue);
+
+    // Other code may have changed any of this since the last flush, so
+    // everything is set again for the first command.
+    queue->state = (DrawState){unset, unset, unset, -1, -1};
+    GL.ActiveTexture(GL_TEXTURE0);
+
+    for (int i = 0; i < count;) {
+        DrawCommand command = queue->commands[queue->order[i++]];
+        while (i < count && canMerge(&command, &queue->commands[queue->order[i]])) {
+            command.count += queue->commands[queue->order[i++]].count;
+        }
+
+        applyState(queue, &command);
+        if (command.indexed) {
+            GL.DrawElementsBaseVertex(
+                command.mode,
+                command.count,
+                GL_UNSIGNED_INT,
+                (void *)(uintptr_t)(command.first * sizeof(GLuint)),
+                command.baseVertex);
+        } else {
+            glDrawArrays(command.mode, command.first, command.count);
+        }
+        queue->stats.drawCalls++;
+    }
+    queue->count = 0;
+}
+
+void DrawQueueClose(DrawQueue *queue) {
+    free(queue->commands);
+    free(queue->keys);
+    free(queue->order);
+    free(queue->sortKeys);
+    free(queue->sortOrder);
+    *queue = (DrawQueue){0};
+}
+
+#endif  // MINO_NO_GL
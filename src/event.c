@@ -0,0 +1,154 @@
+#include "event.h"
+#include "gamepad.h"
+#include "types.h"
+#include "utils.h"
+#include "window.h"
+
+// The queue is shared between a producer and a consumer without locks. The
+// producer only ever writes `tail` and the consumer only ever writes `head`.
+// Publishing an index with release ordering and reading the other side's index
+// with acquire ordering makes sure an event is fully written before it can be
+// read.
+
+bool InputQueuePush(InputQueue *queue, InputEvent event) {
+    uint32 tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    uint32 head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (tail - head >= INPUT_QUEUE_SIZE) {
+        __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    queue->events[tail & (INPUT_QUEUE_SIZE - 1)] = event;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool InputQueuePop(InputQueue *queue, InputEvent *event) {
+    uint32 head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    uint32 tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+    *event = queue->events[head & (INPUT_QUEUE_SIZE - 1)];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void InputQueueClear(InputQueue *queue) {
+    uint32 tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&queue->head, tail, __ATOMIC_RELEASE);
+}
+
+bool WindowPollEvent(Window *window, InputEvent *event) {
+    return InputQueuePop(&window->events, event);
+}
+
+// `eventGamepad` finds the gamepad an event refers to, adding gamepads if the
+// player hasn't been seen before.
+static Gamepad *eventGamepad(Window *window, int playerID) {
+    if (playerID < 0) return nil;
+    while (window->gamepads.len <= playerID) {
+        if (GamepadListPush(&window->gamepads, (Gamepad){.playerID = window->gamepads.len}) == false) {
+            return nil;
+        }
+    }
+    return GamepadListGet(&window->gamepads, playerID);
+}
+
+void InputEventApply(Window *window, const InputEvent *event) {
+    Gamepad *gamepad;
+    switch (event->type) {
+        case InputEventType_KeyPress:
+        case InputEventType_KeyRelease: {
+            // Scripts are written by hand, so events for keys and buttons
+            // that don't exist are dropped rather than set bits out of range.
+            if ((uint)event->key >= Key_Count) return;
+            KeySetPut(&window->keyPressed, event->key, event->type == InputEventType_KeyPress);
+            KeySetUpdateModifiers(&window->keyPressed, event->key);
+            window->KeyMod =
+                (window->KeyMod & (KeyMod_CapsLock | KeyMod_ScrollLock | KeyMod_NumLock)) |
+                (KeySetHas(window->keyPressed, Key_Win) ? KeyMod_Win : 0) |
+                (KeySetHas(window->keyPressed, Key_Alt) ? KeyMod_Alt : 0) |
+                (KeySetHas(window->keyPressed, Key_Shift) ? KeyMod_Shift : 0) |
+                (KeySetHas(window->keyPressed, Key_Ctrl) ? KeyMod_Ctrl : 0);
+        } break;
+
+        case InputEventType_Char: {
+            window->keyChar = event->character;
+        } break;
+
+        case InputEventType_MousePress:
+        case InputEventType_MouseRelease: {
+            if ((uint)event->mouse.button > MouseButton_Forward) return;
+            if (event->type == InputEventType_MousePress) {
+                window->mousePressed = setBit(window->mousePressed, event->mouse.button);
+            } else {
+                window->mousePressed = unsetBit(window->mousePressed, event->mouse.button);
+            }
+            window->mouseX = event->mouse.x;
+            window->mouseY = event->mouse.y;
+        } break;
+
+        case InputEventType_MouseMove: {
+            window->mouseX = event->mouse.x;
+            window->mouseY = event->mouse.y;
+        } break;
+
+        case InputEventType_Scroll: {
+            window->scrollX += event->scroll.x;
+            window->scrollY += event->scroll.y;
+        } break;
+
+        case InputEventType_GamepadPress:
+        case InputEventType_GamepadRelease: {
+            if ((uint)event->gamepad.button >= GamepadButton_Count) return;
+            gamepad = eventGamepad(window, event->gamepad.playerID);
+            if (gamepad == nil) break;
+            if (event->type == InputEventType_GamepadPress) {
+                gamepad->buttons = setBit(gamepad->buttons, event->gamepad.button);
+            } else {
+                gamepad->buttons = unsetBit(gamepad->buttons, event->gamepad.button);
+            }
+        } break;
+
+        case InputEventType_GamepadAxis: {
+            gamepad = eventGamepad(window, event->gamepad.playerID);
+            if (gamepad == nil || event->gamepad.axis >= GamepadAxis_Count) break;
+            gamepad->axes[event->gamepad.axis] = event->gamepad.value;
+        } break;
+
+        case InputEventType_GamepadConnect:
+        case InputEventType_GamepadDisconnect: {
+            gamepad = eventGamepad(window, event->gamepad.playerID);
+            if (gamepad == nil) break;
+            gamepad->connected = event->type == InputEventType_GamepadConnect;
+            if (gamepad->connected == false) {
+                gamepad->buttons = 0;
+                for (int i = 0; i < GamepadAxis_Count; i++) {
+                    gamepad->axes[i] = 0;
+                }
+            }
+        } break;
+    }
+    InputQueuePush(&window->events, *event);
+}
+
+void InputScriptPlay(Window *window, const InputScript *script, int *index, int64 frame) {
+    if (script == nil) return;
+    int64 now = WindowTimeNano();
+    while (*index < script->count && script->entries[*index].frame <= frame) {
+        InputEvent event = script->entries[*index].event;
+        event.time = now;
+        InputEventApply(window, &event);
+        (*index)++;
+    }
+}
+
+int64 InputTimeFromMillis(int64 *offset, int64 millis) {
+    // Events are always received some time after they happen, so the smallest
+    // difference between our clock and the other clock is the best guess of
+    // how far apart they are. If the difference suddenly grows by more than a
+    // second, the other clock probably wrapped around so start over.
+    int64 estimate = WindowTimeNano() - millis * 1000000;
+    if (*offset == 0 || estimate < *offset || estimate - *offset > 1000000000) {
+        *offset = estimate;
+    }
+    return millis * 1000000 + *offset;
+}
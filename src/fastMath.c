@@ -0,0 +1,162 @@
+#include <math.h>
+#include <stdint.h>
+
+#include "fastMath.h"
+#include "types.h"
+#include "utils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(avx2Kernel)
+#include <immintrin.h>
+#endif
+
+// Angles are reduced by subtracting the nearest multiple of π/2, which is
+// split into three parts so the first two products are exact.
+#define twoOverPi 0.636619772367581343f
+#define halfPi1 1.5703125f
+#define halfPi2 4.837512969970703125e-4f
+#define halfPi3 7.54978995489188216e-8f
+
+// Minimax polynomial coefficients for the sine and cosine on [-π/4, π/4].
+#define sin1 -1.6666654611e-1f
+#define sin2 8.3321608736e-3f
+#define sin3 -1.9515295891e-4f
+#define cos1 4.166664568298827e-2f
+#define cos2 -1.388731625493765e-3f
+#define cos3 2.443315711809948e-5f
+
+// `flipSign` flips the sign of `value` if bit 1 of `quadrant` is set.
+static inline float32 flipSign(float32 value, int quadrant) {
+    union {
+        float32 value;
+        uint32_t bits;
+    } flip = {value};
+    flip.bits ^= (uint32_t)(quadrant & 2) << 30;
+    return flip.value;
+}
+
+void FastSinCos(float32 angle, float32 *sin, float32 *cos) {
+    float32 k = angle * twoOverPi;
+    int quadrant = (int)(k + copysignf(0.5f, k));
+    float32 q = (float32)quadrant;
+    float32 r = angle - q * halfPi1 - q * halfPi2 - q * halfPi3;
+
+    float32 r2 = r * r;
+    float32 results[2] = {
+        r + r * r2 * (sin1 + r2 * (sin2 + r2 * sin3)),
+        1 - 0.5f * r2 + r2 * r2 * (cos1 + r2 * (cos2 + r2 * cos3)),
+    };
+
+    // Each quadrant turns the angle by another π/2, which swaps the sine and
+    // cosine and flips the sign of one of them. Picking them by index instead
+    // of branching matters since the quadrant is often unpredictable.
+    int swap = quadrant & 1;
+    *sin = flipSign(results[swap], quadrant);
+    *cos = flipSign(results[swap ^ 1], quadrant + 1);
+}
+
+float32 FastSin(float32 angle) {
+    float32 sin, cos;
+    FastSinCos(angle, &sin, &cos);
+    return sin;
+}
+
+float32 FastCos(float32 angle) {
+    float32 sin, cos;
+    FastSinCos(angle, &sin, &cos);
+    return cos;
+}
+
+#if defined(__SSE2__)
+
+static int sinCosSSE2(const float32 *angles, float32 *sins, float32 *coss, int i, int count) {
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    for (; i + 4 <= count; i += 4) {
+        __m128 angle = _mm_loadu_ps(&angles[i]);
+        __m128 k = _mm_mul_ps(angle, _mm_set1_ps(twoOverPi));
+        __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(k, signBit));
+        __m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(k, half));
+        __m128 q = _mm_cvtepi32_ps(quadrant);
+        __m128 r = _mm_sub_ps(angle, _mm_mul_ps(q, _mm_set1_ps(halfPi1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(halfPi2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(halfPi3)));
+
+        __m128 r2 = _mm_mul_ps(r, r);
+        __m128 s = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(sin3)), _mm_set1_ps(sin2));
+        s = _mm_add_ps(_mm_mul_ps(r2, s), _mm_set1_ps(sin1));
+        s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+        __m128 c = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(cos3)), _mm_set1_ps(cos2));
+        c = _mm_add_ps(_mm_mul_ps(r2, c), _mm_set1_ps(cos1));
+        c = _mm_add_ps(
+            _mm_sub_ps(_mm_set1_ps(1), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+            _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sin = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+        __m128 cos = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+        __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+        if (sins) _mm_storeu_ps(&sins[i], _mm_xor_ps(sin, sinSign));
+        if (coss) _mm_storeu_ps(&coss[i], _mm_xor_ps(cos, cosSign));
+    }
+    return i;
+}
+
+#endif  // __SSE2__
+
+#if defined(avx2Kernel)
+
+static avx2Kernel int sinCosAVX2(const float32 *angles, float32 *sins, float32 *coss, int i, int count) {
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    for (; i + 8 <= count; i += 8) {
+        __m256 angle = _mm256_loadu_ps(&angles[i]);
+        __m256 k = _mm256_mul_ps(angle, _mm256_set1_ps(twoOverPi));
+        __m256 half = _mm256_or_ps(_mm256_set1_ps(0.5f), _mm256_and_ps(k, signBit));
+        __m256i quadrant = _mm256_cvttps_epi32(_mm256_add_ps(k, half));
+        __m256 q = _mm256_cvtepi32_ps(quadrant);
+        __m256 r = _mm256_sub_ps(angle, _mm256_mul_ps(q, _mm256_set1_ps(halfPi1)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(halfPi2)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(halfPi3)));
+
+        __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 s = _mm256_add_ps(_mm256_mul_ps(r2, _mm256_set1_ps(sin3)), _mm256_set1_ps(sin2));
+        s = _mm256_add_ps(_mm256_mul_ps(r2, s), _mm256_set1_ps(sin1));
+        s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), s));
+        __m256 c = _mm256_add_ps(_mm256_mul_ps(r2, _mm256_set1_ps(cos3)), _mm256_set1_ps(cos2));
+        c = _mm256_add_ps(_mm256_mul_ps(r2, c), _mm256_set1_ps(cos1));
+        c = _mm256_add_ps(
+            _mm256_sub_ps(_mm256_set1_ps(1), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)),
+            _mm256_mul_ps(_mm256_mul_ps(r2, r2), c));
+
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+        __m256 sin = _mm256_blendv_ps(s, c, swap);
+        __m256 cos = _mm256_blendv_ps(c, s, swap);
+        __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+        __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+        if (sins) _mm256_storeu_ps(&sins[i], _mm256_xor_ps(sin, sinSign));
+        if (coss) _mm256_storeu_ps(&coss[i], _mm256_xor_ps(cos, cosSign));
+    }
+    return i;
+}
+
+#endif  // avx2Kernel
+
+void SinCosArray(const float32 *angles, float32 *sins, float32 *coss, int count) {
+    int i = 0;
+#if defined(avx2Kernel)
+    if (__builtin_cpu_supports("avx2")) i = sinCosAVX2(angles, sins, coss, i, count);
+#endif
+#if defined(__SSE2__)
+    i = sinCosSSE2(angles, sins, coss, i, count);
+#endif
+    for (; i < count; i++) {
+        float32 sin, cos;
+        FastSinCos(angles[i], &sin, &cos);
+        if (sins) sins[i] = sin;
+        if (coss) coss[i] = cos;
+    }
+}
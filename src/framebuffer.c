@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "damage.h"
+#include "framebuffer.h"
+#include "graphics.h"
+#include "types.h"
+#include "utils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+Pixel ColorToPixel(Color color) {
+    return (Pixel){color.B, color.G, color.R, color.A};
+}
+
+// `clipArea` shrinks the rectangle at (`x`, `y`) to the part inside the
+// framebuffer. `skipX` and `skipY` are set to how many columns and rows were
+// cut off the left and top, so images can skip the same amount. This returns
+// false if nothing is left, otherwise the area the rectangle covers in the
+// window is added to the damage.
+static bool clipArea(Framebuffer *framebuffer, int *x, int *y, int *width, int *height, int *skipX, int *skipY) {
+    *skipX = *x < 0 ? -*x : 0;
+    *skipY = *y < 0 ? -*y : 0;
+    *x += *skipX;
+    *y += *skipY;
+    *width -= *skipX;
+    *height -= *skipY;
+    if (*x + *width > framebuffer->width) *width = framebuffer->width - *x;
+    if (*y + *height > framebuffer->height) *height = framebuffer->height - *y;
+    if (*width <= 0 || *height <= 0) return false;
+
+    int scale = framebuffer->scale;
+    DamageAdd(
+        &framebuffer->damage,
+        framebuffer->offsetX + *x * scale, framebuffer->offsetY + *y * scale,
+        *width * scale, *height * scale);
+    return true;
+}
+
+// `blendPixel` mixes `color` over `pixel`. Dividing by 255 is done with
+// `(t + (t >> 8)) >> 8` (after rounding) which is exact for every value the
+// products can have.
+static Pixel blendPixel(Pixel pixel, Color color) {
+    uint a = color.A, inverse = 255 - a;
+    uint r = color.R * a + pixel.R * inverse + 128;
+    uint g = color.G * a + pixel.G * inverse + 128;
+    uint b = color.B * a + pixel.B * inverse + 128;
+    uint alpha = 255 * a + pixel.A * inverse + 128;
+    return (Pixel){
+        (b + (b >> 8)) >> 8,
+        (g + (g >> 8)) >> 8,
+        (r + (r >> 8)) >> 8,
+        (alpha + (alpha >> 8)) >> 8,
+    };
+}
+
+#if defined(__SSE2__)
+
+// `swizzle` converts 4 colors to pixels by swapping their red and blue bytes.
+static inline __m128i swizzle(__m128i colors) {
+    __m128i alphaGreen = _mm_and_si128(colors, _mm_set1_epi32(0xFF00FF00));
+    __m128i redBlue = _mm_and_si128(colors, _mm_set1_epi32(0x00FF00FF));
+    redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+    return _mm_or_si128(alphaGreen, redBlue);
+}
+
+// `blendHalf` blends the 2 pixels in `source` over the 2 in `destination`,
+// each widened to 16 bits per channel.
+static inline __m128i blendHalf(__m128i source, __m128i destination) {
+    // Channels 3 and 7 are alpha, which is blended with a weight of 255
+    // instead of alpha so the result stays opaque over opaque pixels.
+    const __m128i colorChannels = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaWeight = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF);
+    __m128i weight = _mm_or_si128(_mm_and_si128(alpha, colorChannels), alphaWeight);
+    __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+    __m128i mixed = _mm_add_epi16(_mm_mullo_epi16(source, weight), _mm_mullo_epi16(destination, inverse));
+    mixed = _mm_add_epi16(mixed, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(mixed, _mm_srli_epi16(mixed, 8)), 8);
+}
+
+#endif  // __SSE2__
+
+bool FramebufferSetVirtualResolution(Framebuffer *framebuffer, int width, int height) {
+    if (width > framebuffer->screenWidth || height > framebuffer->screenHeight) return false;
+    if (framebuffer->pixels != framebuffer->screen) free(framebuffer->pixels);
+
+    if (width <= 0 || height <= 0) {
+        framebuffer->pixels = framebuffer->screen;
+        framebuffer->width = framebuffer->screenWidth;
+        framebuffer->height = framebuffer->screenHeight;
+        framebuffer->stride = framebuffer->screenStride;
+        framebuffer->scale = 1;
+        framebuffer->offsetX = framebuffer->offsetY = 0;
+    } else {
+        int scaleX = framebuffer->screenWidth / width;
+        int scaleY = framebuffer->screenHeight / height;
+        int scale = scaleX < scaleY ? scaleX : scaleY;
+        // Rows are padded to 4 pixels so every row starts 16 byte aligned.
+        int stride = (width + 3) & ~3;
+        framebuffer->pixels = allocateN(Pixel, stride * height);
+        if (framebuffer->pixels == nil) {
+            framebuffer->pixels = framebuffer->screen;
+            return false;
+        }
+        framebuffer->width = width;
+        framebuffer->height = height;
+        framebuffer->stride = stride;
+        framebuffer->scale = scale;
+        framebuffer->offsetX = (framebuffer->screenWidth - width * scale) / 2;
+        framebuffer->offsetY = (framebuffer->screenHeight - height * scale) / 2;
+    }
+    DamageAdd(&framebuffer->damage, 0, 0, framebuffer->screenWidth, framebuffer->screenHeight);
+    return true;
+}
+
+void FramebufferUpscale(Framebuffer *framebuffer, DamageRect rect) {
+    if (framebuffer->pixels == framebuffer->screen) return;
+
+    const Pixel border = {0, 0, 0, 255};
+    int scale = framebuffer->scale;
+    int imageLeft = framebuffer->offsetX, imageTop = framebuffer->offsetY;
+    int imageRight = imageLeft + framebuffer->width * scale;
+    int imageBottom = imageTop + framebuffer->height * scale;
+    int left = rect.x > imageLeft ? rect.x : imageLeft;
+    int right = rect.x + rect.width < imageRight ? rect.x + rect.width : imageRight;
+
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        Pixel *row = &framebuffer->screen[y * framebuffer->screenStride];
+        int x = rect.x, end = rect.x + rect.width;
+        if (y < imageTop || y >= imageBottom) {
+            for (; x < end; x++) row[x] = border;
+            continue;
+        }
+
+        // Every `scale` rows in a row are the same, so only the first one
+        // has to be worked out.
+        int sourceY = (y - imageTop) / scale;
+        if (y > rect.y && (y - imageTop) % scale != 0) {
+            const Pixel *previous = &framebuffer->screen[(y - 1) * framebuffer->screenStride];
+            memcpy(&row[rect.x], &previous[rect.x], rect.width * sizeof(Pixel));
+            continue;
+        }
+
+        const Pixel *source = &framebuffer->pixels[sourceY * framebuffer->stride];
+        for (; x < left; x++) row[x] = border;
+        int sourceX = (x - imageLeft) / scale;
+        int repeat = (x - imageLeft) % scale;
+        for (; x < right; x++) {
+            row[x] = source[sourceX];
+            if (++repeat == scale) {
+                repeat = 0;
+                sourceX++;
+            }
+        }
+        for (; x < end; x++) row[x] = border;
+    }
+}
+
+void FramebufferAddDamage(Framebuffer *framebuffer, int x, int y, int width, int height) {
+    int skipX, skipY;
+    clipArea(framebuffer, &x, &y, &width, &height, &skipX, &skipY);
+}
+
+void FramebufferFill(Framebuffer *framebuffer, int x, int y, int width, int height, Color color) {
+    int skipX, skipY;
+    if (clipArea(framebuffer, &x, &y, &width, &height, &skipX, &skipY) == false) return;
+
+    Pixel pixel = ColorToPixel(color);
+    for (int row = 0; row < height; row++) {
+        Pixel *destination = &framebuffer->pixels[(y + row) * framebuffer->stride + x];
+        int i = 0;
+#if defined(__SSE2__)
+        int bits;
+        memcpy(&bits, &pixel, sizeof(bits));
+        __m128i pixels = _mm_set1_epi32(bits);
+        for (; i + 4 <= width; i += 4) {
+            _mm_storeu_si128((__m128i *)&destination[i], pixels);
+        }
+#endif
+        for (; i < width; i++) destination[i] = pixel;
+    }
+}
+
+void FramebufferBlit(Framebuffer *framebuffer, int x, int y, const Color *pixels, int width, int height) {
+    int stride = width;
+    int skipX, skipY;
+    if (clipArea(framebuffer, &x, &y, &width, &height, &skipX, &skipY) == false) return;
+
+    for (int row = 0; row < height; row++) {
+        const Color *source = &pixels[(skipY + row) * stride + skipX];
+        Pixel *destination = &framebuffer->pixels[(y + row) * framebuffer->stride + x];
+        int i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= width; i += 4) {
+            __m128i colors = _mm_loadu_si128((const __m128i *)&source[i]);
+            _mm_storeu_si128((__m128i *)&destination[i], swizzle(colors));
+        }
+#endif
+        for (; i < width; i++) destination[i] = ColorToPixel(source[i]);
+    }
+}
+
+void FramebufferBlend(Framebuffer *framebuffer, int x, int y, const Color *pixels, int width, int height) {
+    int stride = width;
+    int skipX, skipY;
+    if (clipArea(framebuffer, &x, &y, &width, &height, &skipX, &skipY) == false) return;
+
+    for (int row = 0; row < height; row++) {
+        const Color *source = &pixels[(skipY + row) * stride + skipX];
+        Pixel *destination = &framebuffer->pixels[(y + row) * framebuffer->stride + x];
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 4 <= width; i += 4) {
+            __m128i colors = swizzle(_mm_loadu_si128((const __m128i *)&source[i]));
+            __m128i alphas = _mm_and_si128(colors, alphaMask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(alphas, alphaMask)) == 0xFFFF) {
+                _mm_storeu_si128((__m128i *)&destination[i], colors);
+                continue;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(alphas, zero)) == 0xFFFF) continue;
+
+            __m128i current = _mm_loadu_si128((const __m128i *)&destination[i]);
+            __m128i low = blendHalf(_mm_unpacklo_epi8(colors, zero), _mm_unpacklo_epi8(current, zero));
+            __m128i high = blendHalf(_mm_unpackhi_epi8(colors, zero), _mm_unpackhi_epi8(current, zero));
+            _mm_storeu_si128((__m128i *)&destination[i], _mm_packus_epi16(low, high));
+        }
+#endif
+        for (; i < width; i++) {
+            if (source[i].A == 255) {
+                destination[i] = ColorToPixel(source[i]);
+            } else if (source[i].A != 0) {
+                destination[i] = blendPixel(destination[i], source[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#if !defined(MINO_NO_GL)
+
+#include <string.h>
+
+#include "glLoader.h"
+#include "graphics.h"
+#include "types.h"
+#include "utils.h"
+
+GLFunctions GL;
+
+bool GLLoad(Window *window) {
+    bool complete = true;
+#define X(type, name)                                               \
+    GL.name = (type)GraphicsGetProcAddress(window, "gl" #name);     \
+    if (GL.name == nil) complete = false;
+    GL_FUNCTIONS(X)
+#undef X
+    return complete;
+}
+
+bool GLVersionAtLeast(int major, int minor) {
+    // The version string always starts with "<major>.<minor>", though OpenGL
+    // ES contexts put "OpenGL ES " in front of it.
+    const char *version = (const char *)glGetString(GL_VERSION);
+    if (version == nil) return false;
+    while (*version && (*version < '0' || *version > '9')) version++;
+
+    int contextMajor = 0, contextMinor = 0;
+    while (*version >= '0' && *version <= '9') contextMajor = contextMajor * 10 + (*version++ - '0');
+    if (*version == '.') version++;
+    while (*version >= '0' && *version <= '9') contextMinor = contextMinor * 10 + (*version++ - '0');
+
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+bool GLExtensionSupported(const char *name) {
+    if (GL.GetStringi != nil && GLVersionAtLeast(3, 0)) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char *extension = (const char *)GL.GetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+
+    // Older contexts only have one long string of every extension.
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (extensions == nil) return false;
+    int nameLen = strlen(name);
+    for (const char *start = extensions; (start = strstr(start, name)) != nil; start += nameLen) {
+        bool startsWord = start == extensions || start[-1] == ' ';
+        bool endsWord = start[nameLen] == ' ' || start[nameLen] == '\0';
+        if (startsWord && endsWord) return true;
+    }
+    return false;
+}
+
+static GLuint compileShader(GLenum type, const char *source) {
+    GLuint shader = GL.CreateShader(type);
+    GL.ShaderSource(shader, 1, &source, nil);
+    GL.CompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    GL.GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE) {
+        char log[1024];
+        GL.GetShaderInfoLog(shader, sizeof(log), nil, log);
+        println("Could not compile shader: %s", log);
+        GL.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+uint32 GLBuildProgram(const char *vertexSource, const char *fragmentSource) {
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    if (vertex == 0) return 0;
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (fragment == 0) {
+        GL.DeleteShader(vertex);
+        return 0;
+    }
+
+    GLuint program = GL.CreateProgram();
+    GL.AttachShader(program, vertex);
+    GL.AttachShader(program, fragment);
+    GL.LinkProgram(program);
+    GL.DeleteShader(vertex);
+    GL.DeleteShader(fragment);
+
+    GLint linked = GL_FALSE;
+    GL.GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+        char log[1024];
+        GL.GetProgramInfoLog(program, sizeof(log), nil, log);
+        println("Could not link shader program: %s", log);
+        GL.DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+#endif  // MINO_NO_GL
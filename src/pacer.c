@@ -0,0 +1,103 @@
+#include <math.h>
+
+#include "pacer.h"
+#include "types.h"
+#include "window.h"
+
+// The pacer never spins for less than `minSpinTime` or more than
+// `maxSpinTime` nanoseconds. Most systems wake up from a sleep within 100
+// microseconds so the upper bound only matters on very busy machines.
+static const int64 minSpinTime = 50000;
+static const int64 maxSpinTime = 2000000;
+
+static void spinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+void FramePacerInit(FramePacer *pacer, float64 framesPerSecond) {
+    int64 now = WindowTimeNano();
+    int64 interval = (int64)(1000000000.0 / framesPerSecond);
+    *pacer = (FramePacer){
+        .interval = interval,
+        .deadline = now + interval,
+        .spinTime = 500000,
+        .lastWake = now,
+    };
+}
+
+static void recordFrame(FramePacer *pacer, int64 now) {
+    int64 elapsed = now - pacer->lastWake;
+    pacer->lastWake = now;
+
+    int64 error = elapsed - pacer->interval;
+    if (error < 0) error = -error;
+    if (error > pacer->maxError) pacer->maxError = error;
+
+    // Welford's algorithm keeps a running mean and variance without storing
+    // every frame.
+    pacer->frames++;
+    float64 delta = elapsed - pacer->intervalMean;
+    pacer->intervalMean += delta / pacer->frames;
+    pacer->intervalM2 += delta * (elapsed - pacer->intervalMean);
+}
+
+void FramePacerWait(FramePacer *pacer) {
+    int64 now = WindowTimeNano();
+
+    // We are more than an entire frame behind. Trying to catch up would run
+    // frames back to back so start fresh from here instead.
+    if (now - pacer->deadline > pacer->interval) {
+        pacer->missedFrames++;
+        pacer->deadline = now;
+        recordFrame(pacer, now);
+        pacer->deadline += pacer->interval;
+        return;
+    }
+
+    int64 sleepTarget = pacer->deadline - pacer->spinTime;
+    if (now < sleepTarget) {
+        WindowSleepUntil(sleepTarget);
+
+        // Adjust how long to spin depending on how late we woke up. Grow
+        // quickly so the next frame is on time and shrink slowly so one lucky
+        // wake up doesn't make the following frames late.
+        int64 late = WindowTimeNano() - sleepTarget;
+        if (late > pacer->spinTime) {
+            pacer->spinTime = late;
+        } else {
+            pacer->spinTime -= (pacer->spinTime - late) / 16;
+        }
+        if (pacer->spinTime < minSpinTime) pacer->spinTime = minSpinTime;
+        if (pacer->spinTime > maxSpinTime) pacer->spinTime = maxSpinTime;
+    }
+
+    while ((now = WindowTimeNano()) < pacer->deadline) {
+        spinPause();
+    }
+
+    recordFrame(pacer, now);
+    pacer->deadline += pacer->interval;
+}
+
+FramePacerReport FramePacerGetReport(FramePacer *pacer) {
+    FramePacerReport report = {
+        .frames = pacer->frames,
+        .missedFrames = pacer->missedFrames,
+        .averageInterval = pacer->intervalMean,
+        .maxError = pacer->maxError,
+    };
+    if (pacer->frames > 1) {
+        report.jitter = sqrt(pacer->intervalM2 / (pacer->frames - 1));
+    }
+    return report;
+}
+
+void FramePacerResetReport(FramePacer *pacer) {
+    pacer->frames = 0;
+    pacer->missedFrames = 0;
+    pacer->maxError = 0;
+    pacer->intervalMean = 0;
+    pacer->intervalM2 = 0;
+}
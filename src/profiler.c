@@ -0,0 +1,230 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "framebuffer.h"
+#include "glLoader.h"
+#include "graphics.h"
+#include "profiler.h"
+#include "sprite.h"
+#include "types.h"
+#include "utils.h"
+#include "window.h"
+
+static const Color graphBackground = {0x00, 0x00, 0x00, 0xA0};
+static const Color graphTarget = {0xFF, 0xFF, 0xFF, 0xC0};
+static const Color graphGPU = {0xFF, 0x30, 0x30, 0xFF};
+// `graphPhases` are the colors of the parts of each bar, from the bottom up.
+static const Color graphPhases[] = {
+    {0x40, 0x90, 0xFF, 0xFF},
+    {0xB0, 0x60, 0xE0, 0xFF},
+    {0xF0, 0xD0, 0x30, 0xFF},
+    {0x40, 0xC0, 0x60, 0xFF},
+};
+
+void ProfilerInit(Profiler *profiler, int64 targetTime) {
+    *profiler = (Profiler){
+        .targetTime = targetTime > 0 ? targetTime : 1000000000 / 60,
+        .queryFrames = {-1, -1},
+    };
+
+#if !defined(MINO_NO_GL)
+    // Timestamp queries are core since OpenGL 3.3.
+    if (GL.QueryCounter == nil) return;
+    if (GLVersionAtLeast(3, 3) == false && GLExtensionSupported("GL_ARB_timer_query") == false) return;
+    GLuint queries[4];
+    GL.GenQueries(4, queries);
+    for (int i = 0; i < 4; i++) profiler->queries[i / 2][i % 2] = queries[i];
+    profiler->gpu = true;
+#endif
+}
+
+#if !defined(MINO_NO_GL)
+
+// `readQueries` stores the GPU time measured by the queries in `slot` into
+// the frame they measured. Results that aren't ready yet are dropped instead
+// of waiting for them, since the queries are about to be reused.
+static void readQueries(Profiler *profiler, int slot) {
+    int64 frame = profiler->queryFrames[slot];
+    if (frame < 0) return;
+    profiler->queryFrames[slot] = -1;
+
+    GLint available = 0;
+    GL.GetQueryObjectiv(profiler->queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == false || frame < profiler->count - PROFILER_HISTORY) return;
+
+    GLuint64 start = 0, end = 0;
+    GL.GetQueryObjectui64v(profiler->queries[slot][0], GL_QUERY_RESULT, &start);
+    GL.GetQueryObjectui64v(profiler->queries[slot][1], GL_QUERY_RESULT, &end);
+    profiler->frames[frame % PROFILER_HISTORY].gpuTime = (int64)(end - start);
+}
+
+#endif  // MINO_NO_GL
+
+void ProfilerBeginFrame(Profiler *profiler, Window *window) {
+    int64 now = WindowTimeNano();
+    if (profiler->frameStart != 0) {
+        profiler->frames[profiler->count % PROFILER_HISTORY] = (ProfilerFrame){
+            .frameTime = now - profiler->frameStart,
+            .workTime = profiler->workTime,
+            .eventTime = window->stats.eventTime,
+            .controllerTime = window->stats.controllerTime,
+            .swapTime = window->stats.swapTime,
+            .gpuTime = -1,
+        };
+        profiler->count++;
+    }
+    profiler->frameStart = now;
+    profiler->workTime = 0;
+
+#if !defined(MINO_NO_GL)
+    if (profiler->gpu) {
+        // The frame starting now will be number `count`, and reuses the
+        // queries of the frame two before it.
+        int slot = profiler->count % 2;
+        readQueries(profiler, slot);
+        GL.QueryCounter(profiler->queries[slot][0], GL_TIMESTAMP);
+    }
+#endif
+}
+
+void ProfilerEndFrame(Profiler *profiler) {
+    if (profiler->frameStart == 0) return;
+    profiler->workTime = WindowTimeNano() - profiler->frameStart;
+
+#if !defined(MINO_NO_GL)
+    if (profiler->gpu) {
+        int slot = profiler->count % 2;
+        GL.QueryCounter(profiler->queries[slot][1], GL_TIMESTAMP);
+        profiler->queryFrames[slot] = profiler->count;
+    }
+#endif
+}
+
+const ProfilerFrame *ProfilerGetLast(Profiler *profiler) {
+    if (profiler->count == 0) return nil;
+    return &profiler->frames[(profiler->count - 1) % PROFILER_HISTORY];
+}
+
+ProfilerReport ProfilerGetReport(Profiler *profiler) {
+    ProfilerReport report = {0};
+    int64 gpuFrames = 0;
+    int64 first = profiler->count > PROFILER_HISTORY ? profiler->count - PROFILER_HISTORY : 0;
+    for (int64 i = first; i < profiler->count; i++) {
+        const ProfilerFrame *frame = &profiler->frames[i % PROFILER_HISTORY];
+        report.frames++;
+        report.frameTime += frame->frameTime;
+        report.cpuTime += frame->workTime + frame->eventTime + frame->controllerTime;
+        report.swapTime += frame->swapTime;
+        if (frame->frameTime > report.maxFrameTime) report.maxFrameTime = frame->frameTime;
+        if (frame->gpuTime >= 0) {
+            report.gpuTime += frame->gpuTime;
+            gpuFrames++;
+        }
+    }
+    if (report.frames == 0) return report;
+
+    report.frameTime /= report.frames;
+    report.cpuTime /= report.frames;
+    report.swapTime /= report.frames;
+    if (gpuFrames > 0) report.gpuTime /= gpuFrames;
+    report.gpuBound = report.gpuTime > report.cpuTime;
+    return report;
+}
+
+// `drawGraph` lays out the overlay graph inside `area` as rectangles, and
+// passes each to `fill` to draw it onto `target`. The graph is twice
+// `targetTime` tall with the newest frame on the right.
+static void drawGraph(Profiler *profiler, Rect area, void (*fill)(void *target, Rect rect, Color color), void *target) {
+    fill(target, area, graphBackground);
+
+    float64 scale = area.Height / (2.0 * profiler->targetTime);
+    float32 columnWidth = area.Width / PROFILER_HISTORY;
+    float32 bottom = area.Y + area.Height;
+    int64 columns = profiler->count < PROFILER_HISTORY ? profiler->count : PROFILER_HISTORY;
+    for (int64 i = 0; i < columns; i++) {
+        const ProfilerFrame *frame = &profiler->frames[(profiler->count - columns + i) % PROFILER_HISTORY];
+        float32 x = area.X + area.Width - (columns - i) * columnWidth;
+
+        int64 phases[] = {frame->workTime, frame->controllerTime, frame->eventTime, frame->swapTime};
+        float32 top = bottom;
+        for (int j = 0; j < (int)len(phases, int64); j++) {
+            float32 height = fminf(phases[j] * scale, top - area.Y);
+            if (height <= 0) continue;
+            top -= height;
+            fill(target, (Rect){x, top, columnWidth, height}, graphPhases[j]);
+        }
+
+        if (frame->gpuTime >= 0) {
+            float32 y = fmaxf(bottom - frame->gpuTime * scale, area.Y + 1);
+            fill(target, (Rect){x, y - 1, columnWidth, 2}, graphGPU);
+        }
+    }
+
+    fill(target, (Rect){area.X, area.Y + area.Height / 2, area.Width, 1}, graphTarget);
+}
+
+static void fillFramebuffer(void *target, Rect rect, Color color) {
+    // Round the edges rather than the size, so neighboring columns don't
+    // overlap or leave gaps.
+    int left = (int)floorf(rect.X), top = (int)floorf(rect.Y);
+    int right = (int)floorf(rect.X + rect.Width), bottom = (int)floorf(rect.Y + rect.Height);
+    if (right == left) right++;
+    if (bottom == top) bottom++;
+    FramebufferFill(target, left, top, right - left, bottom - top, color);
+}
+
+void ProfilerDrawFramebuffer(Profiler *profiler, Framebuffer *framebuffer, Rect area) {
+    drawGraph(profiler, area, fillFramebuffer, framebuffer);
+}
+
+#if !defined(MINO_NO_GL)
+
+static void fillSprite(void *target, Rect rect, Color color) {
+    Profiler *profiler = target;
+    Aff3 transform = {.A = rect.Width, .D = rect.Height, .TX = rect.X, .TY = rect.Y};
+    SpriteBatchDraw(profiler->overlay, &profiler->white, transform, (Rect){0, 0, 1, 1}, color);
+}
+
+bool ProfilerDraw(Profiler *profiler, Rect area) {
+    if (profiler->overlay == nil) {
+        if (GLVersionAtLeast(3, 3) == false) return false;
+        profiler->overlay = allocate(SpriteBatch);
+        if (profiler->overlay == nil) return false;
+        // Every frame is at most 5 rectangles, plus the background and the
+        // target line.
+        if (SpriteBatchInit(profiler->overlay, PROFILER_HISTORY * 5 + 2) == false ||
+            TextureInit(&profiler->white, 1, 1, &(Color){0xFF, 0xFF, 0xFF, 0xFF}) == false) {
+            ProfilerClose(profiler);
+            return false;
+        }
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    SpriteBatchBegin(profiler->overlay, viewport[2], viewport[3]);
+    drawGraph(profiler, area, fillSprite, profiler);
+    SpriteBatchEnd(profiler->overlay);
+    return true;
+}
+
+#endif  // MINO_NO_GL
+
+void ProfilerClose(Profiler *profiler) {
+#if !defined(MINO_NO_GL)
+    if (profiler->gpu) {
+        GLuint queries[4];
+        for (int i = 0; i < 4; i++) queries[i] = profiler->queries[i / 2][i % 2];
+        GL.DeleteQueries(4, queries);
+        profiler->gpu = false;
+    }
+    if (profiler->overlay) {
+        SpriteBatchClose(profiler->overlay);
+        free(profiler->overlay);
+        profiler->overlay = nil;
+    }
+    TextureClose(&profiler->white);
+    profiler->white = (Texture){0};
+#else
+    (void)profiler;
+#endif
+}
@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event.h"
+#include "gamepad.h"
+#include "keyboard.h"
+#include "record.h"
+#include "snapshot.h"
+#include "types.h"
+#include "utils.h"
+#include "window.h"
+
+// A recording starts with `recordMagic` and a version byte, followed by one
+// entry per frame. Each entry starts with a byte saying which parts of the
+// input changed since the frame before, followed by only those parts:
+//
+//  - recordKeys: the number of keys that were pressed or released, then each
+//    of their key codes.
+//  - recordKeyMod: the new modifier byte.
+//  - recordKeyChar: the character typed this frame.
+//  - recordMouseMove: how far the mouse moved in x and y.
+//  - recordMouseButtons: the new mouse button byte.
+//  - recordScroll: how far the wheel scrolled in x and y this frame.
+//  - recordSize: the new width and height of the window.
+//  - recordGamepads: a byte with a bit set for every gamepad that changed. Each
+//    of those gamepads then has a byte saying what changed, followed by its
+//    new connected byte, the buttons that toggled and a byte with a bit set
+//    for every axis that moved followed by their new values.
+//
+// A frame where nothing changed is stored as a 0 byte followed by the number
+// of unchanged frames in a row. All numbers are stored as variable length
+// integers (7 bits per byte) and signed numbers are zigzag encoded so small
+// negative numbers stay small. Axis values are stored as their exact bits so
+// playback is identical to what was recorded.
+
+static const char recordMagic[4] = {'M', 'R', 'E', 'C'};
+static const byte recordVersion = 1;
+
+enum {
+    recordKeys = 1 << 0,
+    recordKeyMod = 1 << 1,
+    recordKeyChar = 1 << 2,
+    recordMouseMove = 1 << 3,
+    recordMouseButtons = 1 << 4,
+    recordScroll = 1 << 5,
+    recordSize = 1 << 6,
+    recordGamepads = 1 << 7,
+};
+
+enum {
+    recordPadConnected = 1 << 0,
+    recordPadButtons = 1 << 1,
+    recordPadAxes = 1 << 2,
+};
+
+struct InputRecording {
+    bool replaying;
+
+    // `state` is the input of the last frame written or read.
+    InputSnapshot state;
+    rune keyChar;
+    // `idleFrames` counts frames in a row where nothing changed. When
+    // recording, these are written out once something changes. When
+    // replaying, it's how many more frames to wait before reading the next
+    // entry.
+    int64 idleFrames;
+
+    FILE *file;
+
+    byte *data;
+    size_t size;
+    size_t offset;
+    bool finished;
+};
+
+static uint64 zigzag(int64 value) {
+    return ((uint64)value << 1) ^ (uint64)(value >> 63);
+}
+
+static int64 unzigzag(uint64 value) {
+    return (int64)(value >> 1) ^ -(int64)(value & 1);
+}
+
+static void recordPutVarint(FILE *file, uint64 value) {
+    while (value >= 0x80) {
+        putc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    putc((int)value, file);
+}
+
+static void recordPutFloat(FILE *file, float32 value) {
+    // `uint32` may be wider than a float so only copy the float's bytes.
+    uint32 bits = 0;
+    copy(&value, &bits, sizeof(float32));
+    for (int i = 0; i < 4; i++) {
+        putc((int)(bits >> (i * 8)) & 0xFF, file);
+    }
+}
+
+static void recordFlushIdle(InputRecording *recording) {
+    if (recording->idleFrames == 0) return;
+    putc(0, recording->file);
+    recordPutVarint(recording->file, recording->idleFrames);
+    recording->idleFrames = 0;
+}
+
+// `recordPadChanges` returns which parts of two gamepad states differ.
+static byte recordPadChanges(const GamepadSnapshot *before, const GamepadSnapshot *after) {
+    byte changes = 0;
+    if (before->connected != after->connected) changes |= recordPadConnected;
+    if (before->buttons != after->buttons) changes |= recordPadButtons;
+    if (memcmp(before->axes, after->axes, sizeof(after->axes)) != 0) changes |= recordPadAxes;
+    return changes;
+}
+
+static void recordWriteFrame(InputRecording *recording, Window *window) {
+    FILE *file = recording->file;
+    InputSnapshot *before = &recording->state;
+    InputSnapshot after;
+    InputSnapshotCapture(window, &after);
+
+    KeySet changedKeys;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        changedKeys.bits[i] = before->keyPressed.bits[i] ^ after.keyPressed.bits[i];
+    }
+
+    byte changedPads = 0;
+    for (int i = 0; i < INPUT_SNAPSHOT_GAMEPADS; i++) {
+        if (recordPadChanges(&before->gamepads[i], &after.gamepads[i])) changedPads |= 1 << i;
+    }
+
+    byte changes = 0;
+    if (KeySetEmpty(changedKeys) == false) changes |= recordKeys;
+    if (before->keyMod != after.keyMod) changes |= recordKeyMod;
+    if (window->keyChar != 0) changes |= recordKeyChar;
+    if (before->mouseX != after.mouseX || before->mouseY != after.mouseY) changes |= recordMouseMove;
+    if (before->mousePressed != after.mousePressed) changes |= recordMouseButtons;
+    if (after.scrollX != 0 || after.scrollY != 0) changes |= recordScroll;
+    if (before->width != after.width || before->height != after.height) changes |= recordSize;
+    if (changedPads != 0) changes |= recordGamepads;
+
+    if (changes == 0) {
+        recording->idleFrames++;
+        *before = after;
+        return;
+    }
+
+    recordFlushIdle(recording);
+    putc(changes, file);
+
+    if (changes & recordKeys) {
+        KeySet keys = changedKeys;
+        int count = 0;
+        Key key;
+        while (KeySetNext(&keys, &key)) count++;
+        recordPutVarint(file, count);
+        while (KeySetNext(&changedKeys, &key)) recordPutVarint(file, key);
+    }
+    if (changes & recordKeyMod) putc(after.keyMod, file);
+    if (changes & recordKeyChar) recordPutVarint(file, (uint32)window->keyChar);
+    if (changes & recordMouseMove) {
+        recordPutVarint(file, zigzag((int64)after.mouseX - before->mouseX));
+        recordPutVarint(file, zigzag((int64)after.mouseY - before->mouseY));
+    }
+    if (changes & recordMouseButtons) putc(after.mousePressed, file);
+    if (changes & recordScroll) {
+        recordPutVarint(file, zigzag(after.scrollX));
+        recordPutVarint(file, zigzag(after.scrollY));
+    }
+    if (changes & recordSize) {
+        recordPutVarint(file, zigzag(after.width));
+        recordPutVarint(file, zigzag(after.height));
+    }
+    if (changes & recordGamepads) {
+        putc(changedPads, file);
+        for (int i = 0; i < INPUT_SNAPSHOT_GAMEPADS; i++) {
+            if ((changedPads & (1 << i)) == 0) continue;
+            GamepadSnapshot *pad = &after.gamepads[i];
+            byte padChanges = recordPadChanges(&before->gamepads[i], pad);
+            putc(padChanges, file);
+            if (padChanges & recordPadConnected) putc(pad->connected, file);
+            if (padChanges & recordPadButtons) recordPutVarint(file, before->gamepads[i].buttons ^ pad->buttons);
+            if (padChanges & recordPadAxes) {
+                byte axes = 0;
+                for (int j = 0; j < GamepadAxis_Count; j++) {
+                    if (memcmp(&before->gamepads[i].axes[j], &pad->axes[j], sizeof(float32)) != 0) axes |= 1 << j;
+                }
+                putc(axes, file);
+                for (int j = 0; j < GamepadAxis_Count; j++) {
+                    if (axes & (1 << j)) recordPutFloat(file, pad->axes[j]);
+                }
+            }
+        }
+    }
+
+    *before = after;
+}
+
+// The `recordGet` functions read from a recording being replayed. They return
+// false if the recording ended early.
+
+static bool recordGetByte(InputRecording *recording, byte *value) {
+    if (recording->offset >= recording->size) return false;
+    *value = recording->data[recording->offset++];
+    return true;
+}
+
+static bool recordGetVarint(InputRecording *recording, uint64 *value) {
+    *value = 0;
+    byte part;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (recordGetByte(recording, &part) == false) return false;
+        *value |= (uint64)(part & 0x7F) << shift;
+        if ((part & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+static bool recordGetSigned(InputRecording *recording, int *value) {
+    uint64 bits;
+    if (recordGetVarint(recording, &bits) == false) return false;
+    *value = (int)unzigzag(bits);
+    return true;
+}
+
+static bool recordGetFloat(InputRecording *recording, float32 *value) {
+    uint32 bits = 0;
+    byte part;
+    for (int i = 0; i < 4; i++) {
+        if (recordGetByte(recording, &part) == false) return false;
+        bits |= (uint32)part << (i * 8);
+    }
+    copy(&bits, value, sizeof(float32));
+    return true;
+}
+
+// `recordReadFrame` reads the next entry of the recording into `state` and
+// `keyChar`. This returns false once the recording has ended.
+static bool recordReadFrame(InputRecording *recording) {
+    InputSnapshot *state = &recording->state;
+    recording->keyChar = 0;
+    state->scrollX = 0;
+    state->scrollY = 0;
+
+    if (recording->idleFrames > 0) {
+        recording->idleFrames--;
+        return true;
+    }
+
+    byte changes;
+    if (recordGetByte(recording, &changes) == false) return false;
+
+    uint64 value;
+    if (changes == 0) {
+        if (recordGetVarint(recording, &value) == false || value == 0) return false;
+        recording->idleFrames = value - 1;
+        return true;
+    }
+
+    if (changes & recordKeys) {
+        uint64 count;
+        if (recordGetVarint(recording, &count) == false) return false;
+        for (uint64 i = 0; i < count; i++) {
+            if (recordGetVarint(recording, &value) == false || value >= Key_Count) return false;
+            KeySetPut(&state->keyPressed, value, KeySetHas(state->keyPressed, value) == false);
+        }
+    }
+    if (changes & recordKeyMod) {
+        if (recordGetByte(recording, &state->keyMod) == false) return false;
+    }
+    if (changes & recordKeyChar) {
+        if (recordGetVarint(recording, &value) == false) return false;
+        recording->keyChar = (rune)value;
+    }
+    if (changes & recordMouseMove) {
+        int x, y;
+        if (recordGetSigned(recording, &x) == false || recordGetSigned(recording, &y) == false) return false;
+        state->mouseX += x;
+        state->mouseY += y;
+    }
+    if (changes & recordMouseButtons) {
+        if (recordGetByte(recording, &state->mousePressed) == false) return false;
+    }
+    if (changes & recordScroll) {
+        if (recordGetSigned(recording, &state->scrollX) == false) return false;
+        if (recordGetSigned(recording, &state->scrollY) == false) return false;
+    }
+    if (changes & recordSize) {
+        if (recordGetSigned(recording, &state->width) == false) return false;
+        if (recordGetSigned(recording, &state->height) == false) return false;
+    }
+    if (changes & recordGamepads) {
+        byte changedPads;
+        if (recordGetByte(recording, &changedPads) == false) return false;
+        for (int i = 0; i < INPUT_SNAPSHOT_GAMEPADS; i++) {
+            if ((changedPads & (1 << i)) == 0) continue;
+            GamepadSnapshot *pad = &state->gamepads[i];
+            if (i >= state->gamepadCount) state->gamepadCount = i + 1;
+
+            byte padChanges;
+            if (recordGetByte(recording, &padChanges) == false) return false;
+            if (padChanges & recordPadConnected) {
+                byte connected;
+                if (recordGetByte(recording, &connected) == false) return false;
+                pad->connected = connected;
+            }
+            if (padChanges & recordPadButtons) {
+                if (recordGetVarint(recording, &value) == false) return false;
+                pad->buttons ^= (uint32)value;
+            }
+            if (padChanges & recordPadAxes) {
+                byte axes;
+                if (recordGetByte(recording, &axes) == false) return false;
+                for (int j = 0; j < GamepadAxis_Count; j++) {
+                    if ((axes & (1 << j)) == 0) continue;
+                    if (recordGetFloat(recording, &pad->axes[j]) == false) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// `recordApplyFrame` turns the difference between the input state of `window`
+// and the frame that was just read into input events. Going through events
+// keeps `WindowPollEvent` working during playback.
+static void recordApplyFrame(InputRecording *recording, Window *window) {
+    InputSnapshot *state = &recording->state;
+    int64 now = WindowTimeNano();
+
+    KeySet changedKeys;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        changedKeys.bits[i] = window->keyPressed.bits[i] ^ state->keyPressed.bits[i];
+    }
+    Key key;
+    while (KeySetNext(&changedKeys, &key)) {
+        InputEventApply(window, &(InputEvent){
+            .type = KeySetHas(state->keyPressed, key) ? InputEventType_KeyPress : InputEventType_KeyRelease,
+            .time = now,
+            .key = key,
+        });
+    }
+    window->KeyMod = state->keyMod;
+
+    if (recording->keyChar != 0) {
+        InputEventApply(window, &(InputEvent){.type = InputEventType_Char, .time = now, .character = recording->keyChar});
+    }
+
+    if (window->mouseX != state->mouseX || window->mouseY != state->mouseY) {
+        InputEventApply(window, &(InputEvent){
+            .type = InputEventType_MouseMove,
+            .time = now,
+            .mouse = {.x = state->mouseX, .y = state->mouseY},
+        });
+    }
+    byte changedButtons = window->mousePressed ^ state->mousePressed;
+    for (MouseButton button = 0; changedButtons != 0; button++, changedButtons >>= 1) {
+        if ((changedButtons & 1) == 0) continue;
+        InputEventApply(window, &(InputEvent){
+            .type = bitSet(state->mousePressed, button) ? InputEventType_MousePress : InputEventType_MouseRelease,
+            .time = now,
+            .mouse = {.button = button, .x = state->mouseX, .y = state->mouseY},
+        });
+    }
+
+    if (state->scrollX != 0 || state->scrollY != 0) {
+        InputEventApply(window, &(InputEvent){
+            .type = InputEventType_Scroll,
+            .time = now,
+            .scroll = {.x = state->scrollX, .y = state->scrollY},
+        });
+    }
+
+    window->width = state->width;
+    window->height = state->height;
+
+    for (int i = 0; i < state->gamepadCount; i++) {
+        GamepadSnapshot *pad = &state->gamepads[i];
+        Gamepad current = {0};
+        if (i < window->gamepads.len) current = *GamepadListGet(&window->gamepads, i);
+
+        if (current.connected != pad->connected) {
+            InputEventApply(window, &(InputEvent){
+                .type = pad->connected ? InputEventType_GamepadConnect : InputEventType_GamepadDisconnect,
+                .time = now,
+                .gamepad = {.playerID = i},
+            });
+        }
+
+        uint32 changed = current.buttons ^ pad->buttons;
+        for (GamepadButton button = 0; changed != 0; button++, changed >>= 1) {
+            if ((changed & 1) == 0) continue;
+            InputEventApply(window, &(InputEvent){
+                .type = bitSet(pad->buttons, button) ? InputEventType_GamepadPress : InputEventType_GamepadRelease,
+                .time = now,
+                .gamepad = {.playerID = i, .button = button},
+            });
+        }
+
+        for (GamepadAxis axis = 0; axis < GamepadAxis_Count; axis++) {
+            if (memcmp(&current.axes[axis], &pad->axes[axis], sizeof(float32)) == 0) continue;
+            InputEventApply(window, &(InputEvent){
+                .type = InputEventType_GamepadAxis,
+                .time = now,
+                .gamepad = {.playerID = i, .axis = axis, .value = pad->axes[axis]},
+            });
+        }
+    }
+}
+
+bool WindowRecordInput(Window *window, const char *path) {
+    WindowStopRecording(window);
+
+    FILE *file = fopen(path, "wb");
+    if (file == nil) return false;
+    fwrite(recordMagic, 1, sizeof(recordMagic), file);
+    putc(recordVersion, file);
+
+    window->recording = allocate(InputRecording);
+    window->recording->file = file;
+    return true;
+}
+
+bool WindowReplayInput(Window *window, const char *path) {
+    WindowStopRecording(window);
+
+    FILE *file = fopen(path, "rb");
+    if (file == nil) return false;
+
+    byte header[sizeof(recordMagic) + 1];
+    bool valid =
+        fread(header, 1, sizeof(header), file) == sizeof(header) &&
+        memcmp(header, recordMagic, sizeof(recordMagic)) == 0 &&
+        header[sizeof(recordMagic)] == recordVersion;
+
+    size_t size = 0, capacity = 4096;
+    byte *data = valid ? malloc(capacity) : nil;
+    while (data != nil) {
+        size += fread(data + size, 1, capacity - size, file);
+        if (size < capacity) break;
+        capacity *= 2;
+        byte *grown = realloc(data, capacity);
+        if (grown == nil) free(data);
+        data = grown;
+    }
+    fclose(file);
+    if (data == nil) return false;
+
+    window->recording = allocate(InputRecording);
+    window->recording->replaying = true;
+    window->recording->data = data;
+    window->recording->size = size;
+    return true;
+}
+
+bool WindowReplayFinished(Window *window) {
+    InputRecording *recording = window->recording;
+    return recording == nil || recording->replaying == false || recording->finished;
+}
+
+void WindowStopRecording(Window *window) {
+    InputRecording *recording = window->recording;
+    if (recording == nil) return;
+    if (recording->file) {
+        recordFlushIdle(recording);
+        fclose(recording->file);
+    }
+    free(recording->data);
+    free(recording);
+    window->recording = nil;
+}
+
+bool InputRecordingReplaying(Window *window) {
+    return window->recording != nil && window->recording->replaying;
+}
+
+void InputRecordingUpdate(Window *window) {
+    InputRecording *recording = window->recording;
+    if (recording == nil) return;
+    if (recording->replaying == false) {
+        recordWriteFrame(recording, window);
+        return;
+    }
+    if (recording->finished) return;
+    if (recordReadFrame(recording) == false) {
+        recording->finished = true;
+        return;
+    }
+    recordApplyFrame(recording, window);
+}
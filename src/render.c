@@ -0,0 +1,233 @@
+#if !defined(MINO_NO_GL)
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(PLATFORM_Linux)
+#include <pthread.h>
+#endif
+
+#include "glLoader.h"
+#include "render.h"
+#include "types.h"
+#include "utils.h"
+#include "window.h"
+
+// `RenderRecord` comes before the data of every command in a list. `size` is
+// the number of bytes from the start of this record to the next one.
+typedef struct RenderRecord {
+    RenderCommand command;
+    int size;
+} RenderRecord;
+
+// Records are aligned to `recordAlignment` bytes so their data can hold any
+// type, including SIMD vectors.
+#define recordAlignment 16
+
+static int alignRecord(int size) {
+    return (size + recordAlignment - 1) & ~(recordAlignment - 1);
+}
+
+void *RenderThreadRecord(RenderThread *render, RenderCommand command, int size) {
+    RenderList *list = &render->lists[render->recording];
+    int headerSize = alignRecord(sizeof(RenderRecord));
+    int recordSize = headerSize + alignRecord(size);
+    if (list->size + recordSize > list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity : 4096;
+        while (capacity < list->size + recordSize) capacity *= 2;
+        byte *commands = reallocateN(list->commands, byte, capacity);
+        if (commands == nil) return nil;
+        list->commands = commands;
+        list->capacity = capacity;
+    }
+
+    RenderRecord *record = (RenderRecord *)&list->commands[list->size];
+    *record = (RenderRecord){command, recordSize};
+    list->size += recordSize;
+    list->count++;
+    return (byte *)record + headerSize;
+}
+
+void RenderThreadCall(RenderThread *render, RenderCommand command, const void *data, int size) {
+    void *copy = RenderThreadRecord(render, command, size);
+    if (copy && size > 0) memcpy(copy, data, size);
+}
+
+// `drawFrame` runs every command in `list` for a window that was `width` by
+// `height` when the list was submitted, then empties the list.
+static RenderThreadStats drawFrame(RenderThread *render, RenderList *list, int width, int height) {
+    int64 begin = WindowTimeNano();
+    if (render->window->upscaler == nil && (width != render->width || height != render->height)) {
+        glViewport(0, 0, width, height);
+        render->width = width;
+        render->height = height;
+    }
+
+    int headerSize = alignRecord(sizeof(RenderRecord));
+    for (int offset = 0; offset < list->size;) {
+        RenderRecord *record = (RenderRecord *)&list->commands[offset];
+        record->command((byte *)record + headerSize);
+        offset += record->size;
+    }
+
+    RenderThreadStats stats = {
+        .commands = list->count,
+        .replayTime = WindowTimeNano() - begin,
+    };
+    list->size = list->count = 0;
+    return stats;
+}
+
+#if defined(PLATFORM_Linux)
+
+struct RenderThreadNative {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    // `changed` is signaled whenever a frame is submitted or finished, or the
+    // thread is asked to stop.
+    pthread_cond_t changed;
+
+    // `pending` is the index of the list waiting to be drawn, or -1. `busy`
+    // is set while the render thread draws one.
+    int pending;
+    bool busy;
+    bool stop;
+    // `width` and `height` are the size of the window when `pending` was
+    // submitted.
+    int width, height;
+    // `stats` are from the last frame the render thread finished.
+    RenderThreadStats stats;
+};
+
+static void *renderThreadMain(void *data) {
+    RenderThread *render = data;
+    RenderThreadNative *native = render->native;
+    GraphicsMakeCurrent(render->window);
+
+    pthread_mutex_lock(&native->mutex);
+    while (true) {
+        while (native->pending < 0 && native->stop == false) {
+            pthread_cond_wait(&native->changed, &native->mutex);
+        }
+        if (native->pending < 0) break;
+
+        RenderList *list = &render->lists[native->pending];
+        int width = native->width, height = native->height;
+        native->pending = -1;
+        native->busy = true;
+        pthread_mutex_unlock(&native->mutex);
+
+        RenderThreadStats stats = drawFrame(render, list, width, height);
+        stats.swapTime = GraphicsSwapBuffers(render->window);
+
+        pthread_mutex_lock(&native->mutex);
+        native->busy = false;
+        native->stats = stats;
+        pthread_cond_broadcast(&native->changed);
+    }
+    pthread_mutex_unlock(&native->mutex);
+
+    GraphicsReleaseContext(render->window);
+    return nil;
+}
+
+// `waitForIdle` waits until the render thread has drawn everything submitted.
+// The mutex must be locked.
+static void waitForIdle(RenderThreadNative *native) {
+    while (native->pending >= 0 || native->busy) {
+        pthread_cond_wait(&native->changed, &native->mutex);
+    }
+}
+
+#endif  // PLATFORM_Linux
+
+bool RenderThreadInit(RenderThread *render, Window *window) {
+    *render = (RenderThread){
+        .window = window,
+        .width = window->width,
+        .height = window->height,
+    };
+
+#if defined(PLATFORM_Linux)
+    RenderThreadNative *native = render->native = allocate(RenderThreadNative);
+    if (native == nil) return false;
+    native->pending = -1;
+    pthread_mutex_init(&native->mutex, nil);
+    pthread_cond_init(&native->changed, nil);
+
+    // A context can only be current on one thread at a time.
+    if (GraphicsReleaseContext(window) == false) {
+        RenderThreadClose(render);
+        return false;
+    }
+    window->renderThread = render;
+    if (pthread_create(&native->thread, nil, renderThreadMain, render) != 0) {
+        window->renderThread = nil;
+        RenderThreadClose(render);
+        return false;
+    }
+#endif
+    return true;
+}
+
+void RenderThreadSubmit(RenderThread *render) {
+    RenderList *list = &render->lists[render->recording];
+    RenderThreadNative *native = render->native;
+    if (native == nil) {
+        render->stats = drawFrame(render, list, render->window->width, render->window->height);
+        return;
+    }
+
+#if defined(PLATFORM_Linux)
+    // The render thread has to be done with the other list before the game
+    // can record into it.
+    int64 begin = WindowTimeNano();
+    pthread_mutex_lock(&native->mutex);
+    waitForIdle(native);
+    render->stats = native->stats;
+    render->stats.waitTime = WindowTimeNano() - begin;
+
+    native->pending = render->recording;
+    native->width = render->window->width;
+    native->height = render->window->height;
+    pthread_cond_broadcast(&native->changed);
+    pthread_mutex_unlock(&native->mutex);
+#endif
+    render->recording ^= 1;
+}
+
+void RenderThreadSync(RenderThread *render) {
+#if defined(PLATFORM_Linux)
+    RenderThreadNative *native = render->native;
+    if (native == nil) return;
+    pthread_mutex_lock(&native->mutex);
+    waitForIdle(native);
+    pthread_mutex_unlock(&native->mutex);
+#else
+    (void)render;
+#endif
+}
+
+void RenderThreadClose(RenderThread *render) {
+#if defined(PLATFORM_Linux)
+    RenderThreadNative *native = render->native;
+    if (native) {
+        if (render->window->renderThread == render) {
+            pthread_mutex_lock(&native->mutex);
+            waitForIdle(native);
+            native->stop = true;
+            pthread_cond_broadcast(&native->changed);
+            pthread_mutex_unlock(&native->mutex);
+            pthread_join(native->thread, nil);
+            render->window->renderThread = nil;
+        }
+        pthread_cond_destroy(&native->changed);
+        pthread_mutex_destroy(&native->mutex);
+        free(native);
+        GraphicsMakeCurrent(render->window);
+    }
+#endif
+    for (int i = 0; i < 2; i++) free(render->lists[i].commands);
+    *render = (RenderThread){0};
+}
+
+#endif  // MINO_NO_GL
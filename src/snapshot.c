@@ -0,0 +1,62 @@
+#include "snapshot.h"
+#include "types.h"
+#include "utils.h"
+#include "window.h"
+
+// The snapshot is copied one word at a time with relaxed atomics so a reader
+// racing with the writer only ever sees a torn copy (which it throws away)
+// rather than undefined behavior.
+
+void SnapshotPublish(SnapshotLock *lock, const InputSnapshot *snapshot) {
+    uint64 words[len(lock->words, uint64)];
+    copy(snapshot, words, sizeof(InputSnapshot));
+
+    uint32 sequence = __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&lock->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (int i = 0; i < (int)len(lock->words, uint64); i++) {
+        __atomic_store_n(&lock->words[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&lock->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+void SnapshotRead(SnapshotLock *lock, InputSnapshot *snapshot) {
+    uint64 words[len(lock->words, uint64)];
+    uint32 before, after;
+    do {
+        before = __atomic_load_n(&lock->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+        for (int i = 0; i < (int)len(lock->words, uint64); i++) {
+            words[i] = __atomic_load_n(&lock->words[i], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+    copy(words, snapshot, sizeof(InputSnapshot));
+}
+
+void InputSnapshotCapture(Window *window, InputSnapshot *snapshot) {
+    *snapshot = (InputSnapshot){
+        .time = WindowTimeNano(),
+        .keyPressed = window->keyPressed,
+        .keyMod = window->KeyMod,
+        .mouseX = window->mouseX,
+        .mouseY = window->mouseY,
+        .mousePressed = window->mousePressed,
+        .scrollX = window->scrollX,
+        .scrollY = window->scrollY,
+        .width = window->width,
+        .height = window->height,
+    };
+
+    int count = window->gamepads.len;
+    if (count > INPUT_SNAPSHOT_GAMEPADS) count = INPUT_SNAPSHOT_GAMEPADS;
+    snapshot->gamepadCount = count;
+    for (int i = 0; i < count; i++) {
+        Gamepad *gamepad = GamepadListGet(&window->gamepads, i);
+        GamepadSnapshot *pad = &snapshot->gamepads[i];
+        pad->connected = gamepad->connected;
+        pad->buttons = gamepad->buttons;
+        copy(gamepad->axes, pad->axes, sizeof(pad->axes));
+    }
+}
@@ -0,0 +1,321 @@
+#if !defined(MINO_NO_GL)
+
+#include <stdlib.h>
+
+#include "aff3.h"
+#include "glLoader.h"
+#include "graphics.h"
+#include "sprite.h"
+#include "types.h"
+#include "utils.h"
+
+typedef struct SpriteVertex {
+    float32 x, y;
+    float32 u, v;
+    Color color;
+} SpriteVertex;
+
+struct SpriteQuad {
+    SpriteVertex vertices[4];
+};
+
+static const char *spriteVertexShader =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec2 uv;\n"
+    "layout(location = 2) in vec4 color;\n"
+    "uniform vec2 viewport;\n"
+    "out vec2 fragmentUV;\n"
+    "out vec4 fragmentColor;\n"
+    "void main() {\n"
+    "    fragmentUV = uv;\n"
+    "    fragmentColor = color;\n"
+    "    gl_Position = vec4(position.x * 2.0 / viewport.x - 1.0, 1.0 - position.y * 2.0 / viewport.y, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *spriteFragmentShader =
+    "#version 330 core\n"
+    "in vec2 fragmentUV;\n"
+    "in vec4 fragmentColor;\n"
+    "uniform sampler2D image;\n"
+    "out vec4 outColor;\n"
+    "void main() {\n"
+    "    outColor = texture(image, fragmentUV) * fragmentColor;\n"
+    "}\n";
+
+static bool growQueue(SpriteBatch *batch) {
+    int capacity = batch->queueCapacity * 2;
+    SpriteQuad *quads = reallocateN(batch->quads, SpriteQuad, capacity);
+    if (quads == nil) return false;
+    batch->quads = quads;
+    uint64 *keys = reallocateN(batch->keys, uint64, capacity);
+    if (keys == nil) return false;
+    batch->keys = keys;
+    uint64 *sortBuffer = reallocateN(batch->sortBuffer, uint64, capacity);
+    if (sortBuffer == nil) return false;
+    batch->sortBuffer = sortBuffer;
+    batch->queueCapacity = capacity;
+    return true;
+}
+
+bool SpriteBatchInit(SpriteBatch *batch, int capacity) {
+    *batch = (SpriteBatch){.capacity = capacity};
+    if (GLVersionAtLeast(3, 3) == false) return false;
+
+    batch->program = GLBuildProgram(spriteVertexShader, spriteFragmentShader);
+    if (batch->program == 0) return false;
+    GL.UseProgram(batch->program);
+    GL.Uniform1i(GL.GetUniformLocation(batch->program, "image"), 0);
+    batch->viewportLocation = GL.GetUniformLocation(batch->program, "viewport");
+
+    GLuint vertexArray, indexBuffer, vertexBuffer;
+    GL.GenVertexArrays(1, &vertexArray);
+    GL.BindVertexArray(vertexArray);
+    batch->vertexArray = vertexArray;
+
+    // Every quad uses the same 6 indices offset by its first vertex, and draws
+    // always start from index 0 with a base vertex, so the index buffer never
+    // changes.
+    GLuint *indices = allocateN(GLuint, capacity * 6);
+    if (indices == nil) {
+        SpriteBatchClose(batch);
+        return false;
+    }
+    for (int i = 0; i < capacity; i++) {
+        GLuint *quad = &indices[i * 6];
+        quad[0] = i * 4 + 0;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4 + 0;
+        quad[4] = i * 4 + 2;
+        quad[5] = i * 4 + 3;
+    }
+    GL.GenBuffers(1, &indexBuffer);
+    GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    GL.BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * capacity * 6, indices, GL_STATIC_DRAW);
+    batch->indexBuffer = indexBuffer;
+    free(indices);
+
+    GL.GenBuffers(1, &vertexBuffer);
+    GL.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    batch->vertexBuffer = vertexBuffer;
+    if (GLVersionAtLeast(4, 4) || GLExtensionSupported("GL_ARB_buffer_storage")) {
+        GLsizeiptr size = sizeof(SpriteQuad) * capacity * SPRITE_BATCH_REGIONS;
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GL.BufferStorage(GL_ARRAY_BUFFER, size, nil, flags);
+        batch->mapped = GL.MapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    }
+    if (batch->mapped == nil) {
+        GL.BufferData(GL_ARRAY_BUFFER, sizeof(SpriteQuad) * capacity, nil, GL_STREAM_DRAW);
+    }
+
+    GL.EnableVertexAttribArray(0);
+    GL.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, x));
+    GL.EnableVertexAttribArray(1);
+    GL.VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, u));
+    GL.EnableVertexAttribArray(2);
+    GL.VertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, color));
+    GL.BindVertexArray(0);
+
+    batch->queueCapacity = capacity / 2;
+    if (batch->queueCapacity < 64) batch->queueCapacity = 64;
+    if (growQueue(batch) == false) {
+        SpriteBatchClose(batch);
+        return false;
+    }
+    return true;
+}
+
+void SpriteBatchBegin(SpriteBatch *batch, int width, int height) {
+    batch->width = width;
+    batch->height = height;
+    batch->count = 0;
+}
+
+// `queueSprite` queues a sprite whose corners have already been transformed.
+// There must be room for it in the queue.
+static void queueSprite(SpriteBatch *batch, const Texture *texture, const Vec2 *corners, Rect source, Color color) {
+    float32 u0 = source.X / texture->width;
+    float32 v0 = source.Y / texture->height;
+    float32 u1 = (source.X + source.Width) / texture->width;
+    float32 v1 = (source.Y + source.Height) / texture->height;
+
+    SpriteQuad *quad = &batch->quads[batch->count];
+    quad->vertices[0] = (SpriteVertex){corners[0].X, corners[0].Y, u0, v0, color};
+    quad->vertices[1] = (SpriteVertex){corners[1].X, corners[1].Y, u1, v0, color};
+    quad->vertices[2] = (SpriteVertex){corners[2].X, corners[2].Y, u1, v1, color};
+    quad->vertices[3] = (SpriteVertex){corners[3].X, corners[3].Y, u0, v1, color};
+
+    batch->keys[batch->count] = (uint64)texture->id << 32 | batch->count;
+    batch->count++;
+}
+
+void SpriteBatchDraw(SpriteBatch *batch, const Texture *texture, Aff3 transform, Rect source, Color color) {
+    if (batch->count == batch->queueCapacity && growQueue(batch) == false) return;
+
+    // The corners of the quad are (0, 0), (w, 0), (w, h) and (0, h) so the
+    // transform only needs to be worked out in full for the far corner. This
+    // is the same math as `Aff3TransformQuads`, which isn't worth calling for
+    // a single sprite.
+    float32 x = transform.TX, y = transform.TY;
+    float32 wx = transform.A * source.Width, wy = transform.B * source.Width;
+    float32 hx = transform.C * source.Height, hy = transform.D * source.Height;
+    Vec2 corners[4] = {{x, y}, {x + wx, y + wy}, {x + wx + hx, y + wy + hy}, {x + hx, y + hy}};
+    queueSprite(batch, texture, corners, source, color);
+}
+
+// `spriteChunk` is how many sprites `SpriteBatchDrawMany` transforms at once.
+#define spriteChunk 256
+
+void SpriteBatchDrawMany(SpriteBatch *batch, const Texture *texture, const Aff3 *transforms, const Rect *sources, const Color *colors, int count) {
+    Vec2 sizes[spriteChunk];
+    Vec2 corners[spriteChunk * 4];
+    for (int start = 0; start < count; start += spriteChunk) {
+        int chunk = count - start < spriteChunk ? count - start : spriteChunk;
+        while (batch->count + chunk > batch->queueCapacity) {
+            if (growQueue(batch) == false) return;
+        }
+
+        for (int i = 0; i < chunk; i++) {
+            sizes[i] = (Vec2){sources[start + i].Width, sources[start + i].Height};
+        }
+        Aff3TransformQuads(&transforms[start], sizes, corners, chunk);
+        for (int i = 0; i < chunk; i++) {
+            queueSprite(batch, texture, &corners[i * 4], sources[start + i], colors[start + i]);
+        }
+    }
+}
+
+// `sortByTexture` sorts `keys` by texture using a radix sort on the top 32
+// bits. Radix sorting is stable, so sprites sharing a texture stay in the
+// order they were queued. Passes where every key has the same digit (which is
+// common since there are usually only a few textures) are skipped.
+static void sortByTexture(uint64 **keys, uint64 **buffer, int count) {
+    for (int shift = 32; shift < 64; shift += 8) {
+        int offsets[256] = {0};
+        for (int i = 0; i < count; i++) offsets[((*keys)[i] >> shift) & 0xFF]++;
+        if (offsets[((*keys)[0] >> shift) & 0xFF] == count) continue;
+
+        int total = 0;
+        for (int i = 0; i < 256; i++) {
+            int digits = offsets[i];
+            offsets[i] = total;
+            total += digits;
+        }
+        for (int i = 0; i < count; i++) {
+            uint64 key = (*keys)[i];
+            (*buffer)[offsets[(key >> shift) & 0xFF]++] = key;
+        }
+
+        uint64 *sorted = *buffer;
+        *buffer = *keys;
+        *keys = sorted;
+    }
+}
+
+// `waitForFence` blocks until the GPU has passed `fence` then deletes it.
+static void waitForFence(void *fence) {
+    if (fence == nil) return;
+    while (GL.ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {
+    }
+    GL.DeleteSync(fence);
+}
+
+// `reserveQuads` finds room for up to `count` quads in the vertex buffer. It
+// returns where to write them and sets `reserved` to how many fit and `base`
+// to the index of the first one in the buffer.
+static SpriteQuad *reserveQuads(SpriteBatch *batch, int count, int *reserved, int *base) {
+    if (batch->mapped == nil) {
+        // Replacing the whole buffer lets the driver hand us fresh memory
+        // instead of waiting for draws still using the old contents.
+        *reserved = count < batch->capacity ? count : batch->capacity;
+        *base = 0;
+        return GL.MapBufferRange(
+            GL_ARRAY_BUFFER,
+            0,
+            sizeof(SpriteQuad) * *reserved,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+
+    int regionEnd = (batch->region + 1) * batch->capacity;
+    if (batch->head == regionEnd) {
+        // Mark where the GPU will be done with this region, then move on to
+        // the next one once the GPU is done with it.
+        batch->fences[batch->region] = GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        batch->region = (batch->region + 1) % SPRITE_BATCH_REGIONS;
+        batch->head = batch->region * batch->capacity;
+        regionEnd = batch->head + batch->capacity;
+        waitForFence(batch->fences[batch->region]);
+        batch->fences[batch->region] = nil;
+    }
+
+    int space = regionEnd - batch->head;
+    *reserved = count < space ? count : space;
+    *base = batch->head;
+    batch->head += *reserved;
+    return &batch->mapped[*base];
+}
+
+void SpriteBatchEnd(SpriteBatch *batch) {
+    int count = batch->count;
+    batch->stats = (SpriteBatchStats){.sprites = count};
+    if (count == 0) return;
+
+    sortByTexture(&batch->keys, &batch->sortBuffer, count);
+    uint64 *keys = batch->keys;
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GL.UseProgram(batch->program);
+    GL.Uniform2f(batch->viewportLocation, batch->width, batch->height);
+    GL.BindVertexArray(batch->vertexArray);
+    GL.BindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer);
+    GL.ActiveTexture(GL_TEXTURE0);
+
+    for (int i = 0; i < count;) {
+        int reserved, base;
+        SpriteQuad *quads = reserveQuads(batch, count - i, &reserved, &base);
+        if (quads == nil) break;
+        for (int j = 0; j < reserved; j++) {
+            quads[j] = batch->quads[keys[i + j] & 0xFFFFFFFF];
+        }
+        if (batch->mapped == nil) GL.UnmapBuffer(GL_ARRAY_BUFFER);
+
+        // Every run of sprites with the same texture is one draw call.
+        for (int j = 0; j < reserved;) {
+            uint32 texture = keys[i + j] >> 32;
+            int start = j;
+            while (j < reserved && keys[i + j] >> 32 == texture) j++;
+
+            glBindTexture(GL_TEXTURE_2D, texture);
+            GL.DrawElementsBaseVertex(GL_TRIANGLES, (j - start) * 6, GL_UNSIGNED_INT, nil, (base + start) * 4);
+            batch->stats.drawCalls++;
+        }
+        i += reserved;
+    }
+
+    GL.BindVertexArray(0);
+    batch->count = 0;
+}
+
+void SpriteBatchClose(SpriteBatch *batch) {
+    for (int i = 0; i < SPRITE_BATCH_REGIONS; i++) {
+        if (batch->fences[i]) GL.DeleteSync(batch->fences[i]);
+    }
+    if (batch->mapped) {
+        GL.BindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer);
+        GL.UnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    if (batch->vertexBuffer || batch->indexBuffer) {
+        GL.DeleteBuffers(2, (GLuint[]){batch->vertexBuffer, batch->indexBuffer});
+    }
+    if (batch->vertexArray) GL.DeleteVertexArrays(1, &(GLuint){batch->vertexArray});
+    if (batch->program) GL.DeleteProgram(batch->program);
+    free(batch->quads);
+    free(batch->keys);
+    free(batch->sortBuffer);
+    *batch = (SpriteBatch){0};
+}
+
+#endif  // MINO_NO_GL
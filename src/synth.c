@@ -2,6 +2,7 @@
 
 #include "synth.h"
 #include "consts.h"
+#include "fastMath.h"
 
 void WaveMultiply(float32 *wave, int length, float32 scale) {
     for (int i = 0; i < length; i++) {
@@ -34,9 +35,17 @@ void CreateSineOscillator(Oscillator* oscillator)  {
 void OscillatorStream(Oscillator oscillator, float32* wave, int length) {
     switch (oscillator.type) {
         case SineOscillator: {
+#if defined(MINO_FAST_MATH)
+            // The phases are turned into angles in place, then into sines.
+            for (int i = 0; i < length; i++) {
+                wave[i] = (wave[i] + 1) * PI_2 / 2;
+            }
+            SinCosArray(wave, wave, nil, length);
+#else
             for (int i = 0; i < length; i++) {
                 wave[i] = sinf((wave[i] + 1) * PI_2 / 2);
             }
+#endif
         } break;
 
         case SawOscillator: {
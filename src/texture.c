@@ -0,0 +1,46 @@
+#if !defined(MINO_NO_GL)
+
+#include "glLoader.h"
+#include "graphics.h"
+#include "types.h"
+
+bool TextureInit(Texture *texture, int width, int height, const Color *pixels) {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    if (id == 0) return false;
+
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    *texture = (Texture){
+        .id = id,
+        .width = width,
+        .height = height,
+    };
+    return true;
+}
+
+void TextureUpdate(Texture *texture, Rect area, const Color *pixels) {
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        (GLint)area.X, (GLint)area.Y,
+        (GLsizei)area.Width, (GLsizei)area.Height,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        pixels);
+}
+
+void TextureClose(Texture *texture) {
+    if (texture->id == 0) return;
+    GLuint id = texture->id;
+    glDeleteTextures(1, &id);
+    texture->id = 0;
+}
+
+#endif  // MINO_NO_GL
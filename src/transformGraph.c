@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "aff3.h"
+#include "transformGraph.h"
+#include "types.h"
+#include "utils.h"
+
+// `TransformSlot` is everything stored about the node at one index, used to
+// carry nodes around while reordering the arrays.
+typedef struct TransformSlot {
+    Aff3 local, world;
+    int parent, id;
+    uint8 dirty;
+} TransformSlot;
+
+bool TransformGraphInit(TransformGraph *graph, int capacity) {
+    *graph = (TransformGraph){0};
+    if (capacity < 1) capacity = 1;
+
+    graph->locals = allocateN(Aff3, capacity);
+    graph->worlds = allocateN(Aff3, capacity);
+    graph->parents = allocateN(int, capacity);
+    graph->ids = allocateN(int, capacity);
+    graph->dirty = allocateN(uint8, capacity);
+    graph->indexes = allocateN(int, capacity);
+    graph->freeIds = allocateN(int, capacity);
+    graph->scratch = allocateN(int, capacity);
+    graph->capacity = capacity;
+    if (graph->locals == nil || graph->worlds == nil || graph->parents == nil || graph->ids == nil ||
+        graph->dirty == nil || graph->indexes == nil || graph->freeIds == nil || graph->scratch == nil) {
+        TransformGraphClose(graph);
+        return false;
+    }
+    return true;
+}
+
+static bool growNodes(TransformGraph *graph) {
+    int capacity = graph->capacity * 2;
+    Aff3 *locals = reallocateN(graph->locals, Aff3, capacity);
+    if (locals == nil) return false;
+    graph->locals = locals;
+    Aff3 *worlds = reallocateN(graph->worlds, Aff3, capacity);
+    if (worlds == nil) return false;
+    graph->worlds = worlds;
+    int *parents = reallocateN(graph->parents, int, capacity);
+    if (parents == nil) return false;
+    graph->parents = parents;
+    int *ids = reallocateN(graph->ids, int, capacity);
+    if (ids == nil) return false;
+    graph->ids = ids;
+    uint8 *dirty = reallocateN(graph->dirty, uint8, capacity);
+    if (dirty == nil) return false;
+    graph->dirty = dirty;
+    int *indexes = reallocateN(graph->indexes, int, capacity);
+    if (indexes == nil) return false;
+    graph->indexes = indexes;
+    int *freeIds = reallocateN(graph->freeIds, int, capacity);
+    if (freeIds == nil) return false;
+    graph->freeIds = freeIds;
+    int *scratch = reallocateN(graph->scratch, int, capacity);
+    if (scratch == nil) return false;
+    graph->scratch = scratch;
+    graph->capacity = capacity;
+    return true;
+}
+
+static bool isNode(const TransformGraph *graph, int node) {
+    return node >= 0 && node < graph->nextId && graph->indexes[node] >= 0;
+}
+
+static void markDirty(TransformGraph *graph, int index) {
+    graph->dirty[index] = 1;
+    if (index < graph->firstDirty) graph->firstDirty = index;
+}
+
+int TransformGraphAdd(TransformGraph *graph, int parent, Aff3 local) {
+    if (parent != TRANSFORM_ROOT && isNode(graph, parent) == false) return -1;
+    if (graph->count == graph->capacity && growNodes(graph) == false) return -1;
+
+    // Every id below `nextId` is either used or free, so there's always room
+    // for a new one while there's room for a new node.
+    int id = graph->freeCount > 0 ? graph->freeIds[--graph->freeCount] : graph->nextId++;
+    int index = graph->count++;
+    graph->locals[index] = local;
+    graph->worlds[index] = local;
+    graph->parents[index] = parent == TRANSFORM_ROOT ? TRANSFORM_ROOT : graph->indexes[parent];
+    graph->ids[index] = id;
+    graph->indexes[id] = index;
+    markDirty(graph, index);
+    return id;
+}
+
+// `markSubtree` sets `scratch[i]` to 1 for the node at `index` and every node
+// below it, and to 0 for the other nodes from `index` on. Nodes below a node
+// always come after it, so nothing before `index` can be part of it.
+static void markSubtree(TransformGraph *graph, int index) {
+    int *marks = graph->scratch;
+    marks[index] = 1;
+    for (int i = index + 1; i < graph->count; i++) {
+        int parent = graph->parents[i];
+        marks[i] = parent >= index && marks[parent];
+    }
+}
+
+void TransformGraphRemove(TransformGraph *graph, int node) {
+    if (isNode(graph, node) == false) return;
+    int first = graph->indexes[node];
+    markSubtree(graph, first);
+
+    // The nodes that are kept are moved down over the removed ones, which
+    // keeps their order. Once a node is looked at, its mark is replaced with
+    // its new index so the nodes below it can find it.
+    int *scratch = graph->scratch;
+    int kept = first;
+    for (int i = first; i < graph->count; i++) {
+        int id = graph->ids[i];
+        if (scratch[i]) {
+            graph->indexes[id] = -1;
+            graph->freeIds[graph->freeCount++] = id;
+            continue;
+        }
+
+        int parent = graph->parents[i];
+        graph->locals[kept] = graph->locals[i];
+        graph->worlds[kept] = graph->worlds[i];
+        graph->parents[kept] = parent < first ? parent : scratch[parent];
+        graph->ids[kept] = id;
+        graph->dirty[kept] = graph->dirty[i];
+        graph->indexes[id] = kept;
+        scratch[i] = kept++;
+    }
+    graph->count = kept;
+    if (first < graph->firstDirty) graph->firstDirty = first;
+}
+
+static TransformSlot loadSlot(const TransformGraph *graph, int index) {
+    return (TransformSlot){
+        graph->locals[index],
+        graph->worlds[index],
+        graph->parents[index],
+        graph->ids[index],
+        graph->dirty[index],
+    };
+}
+
+static void storeSlot(TransformGraph *graph, int index, TransformSlot slot) {
+    graph->locals[index] = slot.local;
+    graph->worlds[index] = slot.world;
+    graph->parents[index] = slot.parent;
+    graph->ids[index] = slot.id;
+    graph->dirty[index] = slot.dirty;
+    graph->indexes[slot.id] = index;
+}
+
+// `moveSubtreeToEnd` moves the node at `index` and every node below it after
+// all the others. The others keep their order, and so do the moved ones, so
+// parents still come before their children as long as the new parent of
+// `index` isn't one of the moved nodes.
+static void moveSubtreeToEnd(TransformGraph *graph, int index) {
+    markSubtree(graph, index);
+    int *scratch = graph->scratch;
+    int count = graph->count;
+    int moved = 0;
+    for (int i = index; i < count; i++) moved += scratch[i];
+
+    // `scratch[i]` becomes the index the node at `i` moves to.
+    int stay = index, end = count - moved;
+    for (int i = index; i < count; i++) scratch[i] = scratch[i] ? end++ : stay++;
+    for (int i = index; i < count; i++) {
+        int parent = graph->parents[i];
+        if (parent >= index) graph->parents[i] = scratch[parent];
+    }
+
+    // The nodes are moved by following each cycle of the permutation, so
+    // nothing has to be allocated. Nodes are marked done with -1.
+    for (int start = index; start < count; start++) {
+        if (scratch[start] < 0) continue;
+        TransformSlot carried = loadSlot(graph, start);
+        int target = scratch[start];
+        scratch[start] = -1;
+        while (target != start) {
+            TransformSlot next = loadSlot(graph, target);
+            int after = scratch[target];
+            storeSlot(graph, target, carried);
+            scratch[target] = -1;
+            carried = next;
+            target = after;
+        }
+        storeSlot(graph, start, carried);
+    }
+    if (index < graph->firstDirty) graph->firstDirty = index;
+}
+
+bool TransformGraphSetParent(TransformGraph *graph, int node, int parent) {
+    if (isNode(graph, node) == false) return false;
+    if (parent != TRANSFORM_ROOT && isNode(graph, parent) == false) return false;
+    int index = graph->indexes[node];
+    int parentIndex = parent == TRANSFORM_ROOT ? TRANSFORM_ROOT : graph->indexes[parent];
+    for (int i = parentIndex; i != TRANSFORM_ROOT; i = graph->parents[i]) {
+        if (i == index) return false;
+    }
+
+    graph->parents[index] = parentIndex;
+    markDirty(graph, index);
+    if (parentIndex > index) moveSubtreeToEnd(graph, index);
+    return true;
+}
+
+void TransformGraphSetLocal(TransformGraph *graph, int node, Aff3 local) {
+    if (isNode(graph, node) == false) return;
+    int index = graph->indexes[node];
+    graph->locals[index] = local;
+    markDirty(graph, index);
+}
+
+Aff3 TransformGraphGetLocal(const TransformGraph *graph, int node) {
+    if (isNode(graph, node) == false) return Aff3Identity();
+    return graph->locals[graph->indexes[node]];
+}
+
+Aff3 TransformGraphGetWorld(const TransformGraph *graph, int node) {
+    if (isNode(graph, node) == false) return Aff3Identity();
+    return graph->worlds[graph->indexes[node]];
+}
+
+void TransformGraphUpdate(TransformGraph *graph) {
+    int count = graph->count;
+    int first = graph->firstDirty;
+    graph->updated = 0;
+    if (first >= count) return;
+
+    // A node needs updating if it's dirty or its parent was updated, so
+    // updated nodes are marked dirty for their children to see. Parents come
+    // first, so they're always done by the time their children are reached.
+    for (int i = first; i < count; i++) {
+        int parent = graph->parents[i];
+        if (graph->dirty[i] == 0 && (parent == TRANSFORM_ROOT || graph->dirty[parent] == 0)) continue;
+        graph->worlds[i] = parent == TRANSFORM_ROOT ? graph->locals[i] : Aff3Concat(graph->locals[i], graph->worlds[parent]);
+        graph->dirty[i] = 1;
+        graph->updated++;
+    }
+    memset(&graph->dirty[first], 0, count - first);
+    graph->firstDirty = count;
+}
+
+void TransformGraphClear(TransformGraph *graph) {
+    graph->count = 0;
+    graph->freeCount = 0;
+    graph->nextId = 0;
+    graph->firstDirty = 0;
+    graph->updated = 0;
+}
+
+void TransformGraphClose(TransformGraph *graph) {
+    free(graph->locals);
+    free(graph->worlds);
+    free(graph->parents);
+    free(graph->ids);
+    free(graph->dirty);
+    free(graph->indexes);
+    free(graph->freeIds);
+    free(graph->scratch);
+    *graph = (TransformGraph){0};
+}
@@ -0,0 +1,343 @@
+#if !defined(MINO_NO_GL)
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "glLoader.h"
+#include "types.h"
+#include "upscale.h"
+#include "utils.h"
+#include "window.h"
+
+// `timerQueries` is how many frames can be measured at once. Results arrive a
+// few frames late, so there has to be a query for each of those frames.
+#define timerQueries 4
+
+struct Upscaler {
+    int width, height;
+    Upscaling upscaling;
+
+    // `renderWidth` and `renderHeight` are the part of the target drawn to,
+    // which is smaller than `width` by `height` when the render scale is
+    // below 1.
+    int renderWidth, renderHeight;
+    float32 renderScale;
+
+    // Dynamic resolution is on when `targetTime` isn't 0.
+    int64 targetTime;
+    float32 minScale, maxScale;
+    // `gpuTime` is a smoothed measure of how long the GPU took per frame.
+    float64 gpuTime;
+    // `queries` is a ring of timer queries, one per measured frame. The
+    // `pending` ones starting at `firstQuery` are waiting for results, and
+    // each remembers the render scale its frame was drawn at.
+    GLuint queries[timerQueries];
+    float32 queryScales[timerQueries];
+    int firstQuery, pending;
+    bool measuring;
+
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthBuffer;
+    GLuint program;
+    // `vertexArray` is empty since the quad's corners come from
+    // `gl_VertexID`, but core contexts can't draw without one.
+    GLuint vertexArray;
+    GLint sizeLocation, textureSizeLocation, scaleLocation;
+};
+
+static const char *upscaleVertexShader =
+    "#version 330 core\n"
+    "out vec2 uv;\n"
+    "void main() {\n"
+    "    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+    "    uv = corner;\n"
+    "    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+// Sharp bilinear sampling moves every sample to the center of its texel
+// except within half a screen pixel of the texel's edges, where it's left for
+// bilinear filtering to blend. With a whole number `scale` this is the same as
+// plain nearest sampling. `size` is the drawn part of the texture, which may
+// be smaller than all of it (`textureSize`).
+static const char *upscaleFragmentShader =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "uniform sampler2D image;\n"
+    "uniform vec2 size;\n"
+    "uniform vec2 textureSize;\n"
+    "uniform vec2 scale;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "    vec2 texel = uv * size;\n"
+    "    vec2 center = fract(texel) - 0.5;\n"
+    "    vec2 region = 0.5 - 0.5 / scale;\n"
+    "    vec2 offset = (center - clamp(center, -region, region)) * scale + 0.5;\n"
+    "    color = texture(image, (floor(texel) + offset) / textureSize);\n"
+    "}\n";
+
+void UpscalerClose(Window *window) {
+    Upscaler *upscaler = window->upscaler;
+    if (upscaler == nil) return;
+    if (upscaler->framebuffer) {
+        GL.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        GL.DeleteFramebuffers(1, &upscaler->framebuffer);
+    }
+    if (upscaler->colorTexture) glDeleteTextures(1, &upscaler->colorTexture);
+    if (upscaler->depthBuffer) GL.DeleteRenderbuffers(1, &upscaler->depthBuffer);
+    if (upscaler->vertexArray) GL.DeleteVertexArrays(1, &upscaler->vertexArray);
+    if (upscaler->program) GL.DeleteProgram(upscaler->program);
+    if (upscaler->queries[0]) {
+        if (upscaler->measuring) GL.EndQuery(GL_TIME_ELAPSED);
+        GL.DeleteQueries(timerQueries, upscaler->queries);
+    }
+    free(upscaler);
+    window->upscaler = nil;
+    glViewport(0, 0, window->width, window->height);
+}
+
+bool GraphicsSetVirtualResolution(Window *window, int width, int height, Upscaling upscaling) {
+    UpscalerClose(window);
+    if (width <= 0 || height <= 0) return true;
+    if (GLVersionAtLeast(3, 3) == false) return false;
+
+    Upscaler *upscaler = window->upscaler = allocate(Upscaler);
+    upscaler->width = upscaler->renderWidth = width;
+    upscaler->height = upscaler->renderHeight = height;
+    upscaler->renderScale = 1;
+    upscaler->upscaling = upscaling;
+
+    upscaler->program = GLBuildProgram(upscaleVertexShader, upscaleFragmentShader);
+    if (upscaler->program == 0) {
+        UpscalerClose(window);
+        return false;
+    }
+    GL.UseProgram(upscaler->program);
+    GL.Uniform1i(GL.GetUniformLocation(upscaler->program, "image"), 0);
+    upscaler->sizeLocation = GL.GetUniformLocation(upscaler->program, "size");
+    upscaler->textureSizeLocation = GL.GetUniformLocation(upscaler->program, "textureSize");
+    upscaler->scaleLocation = GL.GetUniformLocation(upscaler->program, "scale");
+    GL.UseProgram(0);
+    GL.GenVertexArrays(1, &upscaler->vertexArray);
+
+    // When the window converts to sRGB, the target has to store sRGB colors
+    // too or they'd be converted twice.
+    GLenum format = glIsEnabled(GL_FRAMEBUFFER_SRGB) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    GLenum filter = upscaling == Upscaling_Integer ? GL_NEAREST : GL_LINEAR;
+    glGenTextures(1, &upscaler->colorTexture);
+    glBindTexture(GL_TEXTURE_2D, upscaler->colorTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nil);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GL.GenRenderbuffers(1, &upscaler->depthBuffer);
+    GL.BindRenderbuffer(GL_RENDERBUFFER, upscaler->depthBuffer);
+    GL.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    GL.BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GL.GenFramebuffers(1, &upscaler->framebuffer);
+    GL.BindFramebuffer(GL_FRAMEBUFFER, upscaler->framebuffer);
+    GL.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, upscaler->colorTexture, 0);
+    GL.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, upscaler->depthBuffer);
+    if (GL.CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        println("Could not create a %dx%d render target", width, height);
+        UpscalerClose(window);
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+uint32 GraphicsGetFramebuffer(Window *window) {
+    if (window->upscaler == nil) return 0;
+    return window->upscaler->framebuffer;
+}
+
+// `beginMeasuring` starts timing the GPU work of the next frame, unless every
+// query is still waiting for its result.
+static void beginMeasuring(Upscaler *upscaler) {
+    if (upscaler->pending == timerQueries) return;
+    int query = (upscaler->firstQuery + upscaler->pending) % timerQueries;
+    upscaler->queryScales[query] = upscaler->renderScale;
+    GL.BeginQuery(GL_TIME_ELAPSED, upscaler->queries[query]);
+    upscaler->measuring = true;
+}
+
+static void setRenderScale(Upscaler *upscaler, float32 scale) {
+    if (scale < upscaler->minScale) scale = upscaler->minScale;
+    if (scale > upscaler->maxScale) scale = upscaler->maxScale;
+    upscaler->renderScale = scale;
+    upscaler->renderWidth = (int)(upscaler->width * scale + 0.5f);
+    upscaler->renderHeight = (int)(upscaler->height * scale + 0.5f);
+    if (upscaler->renderWidth < 1) upscaler->renderWidth = 1;
+    if (upscaler->renderHeight < 1) upscaler->renderHeight = 1;
+}
+
+// `adjustRenderScale` picks a new render scale from a frame that took `time`
+// nanoseconds on the GPU.
+static void adjustRenderScale(Upscaler *upscaler, float64 time) {
+    // Slow frames are reacted to straight away but fast ones are averaged
+    // over a while, so a single quick frame doesn't bring a spike back.
+    float64 weight = time > upscaler->gpuTime ? 0.5 : 0.05;
+    if (upscaler->gpuTime == 0) weight = 1;
+    upscaler->gpuTime += (time - upscaler->gpuTime) * weight;
+
+    // GPU time is mostly proportional to the number of pixels drawn, which
+    // goes with the square of the scale. Scaling up is also capped so it
+    // creeps towards the target instead of overshooting it.
+    float64 ratio = upscaler->targetTime / upscaler->gpuTime;
+    float32 scale = upscaler->renderScale;
+    if (ratio < 1) {
+        scale *= sqrt(ratio);
+    } else if (ratio > 1.2) {
+        scale *= fmin(sqrt(ratio), 1.02);
+    }
+    setRenderScale(upscaler, scale);
+}
+
+// `finishMeasuring` ends the timer query for this frame and reads the results
+// of any earlier ones that are ready, without waiting for the GPU.
+static void finishMeasuring(Upscaler *upscaler) {
+    if (upscaler->measuring) {
+        GL.EndQuery(GL_TIME_ELAPSED);
+        upscaler->measuring = false;
+        upscaler->pending++;
+    }
+
+    while (upscaler->pending > 0) {
+        int query = upscaler->firstQuery;
+        GLint available = 0;
+        GL.GetQueryObjectiv(upscaler->queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == false) break;
+
+        GLuint64 time = 0;
+        GL.GetQueryObjectui64v(upscaler->queries[query], GL_QUERY_RESULT, &time);
+        upscaler->firstQuery = (query + 1) % timerQueries;
+        upscaler->pending--;
+
+        // Frames drawn before the last change don't say anything about the
+        // current scale, and would make it change again before the first
+        // change has had a chance to show up.
+        if (upscaler->queryScales[query] == upscaler->renderScale) {
+            adjustRenderScale(upscaler, time);
+        }
+    }
+}
+
+bool GraphicsSetDynamicResolution(Window *window, float32 minScale, float32 maxScale, int64 targetTime) {
+    Upscaler *upscaler = window->upscaler;
+    if (upscaler == nil) return false;
+    // The target is only as big as the virtual resolution.
+    if (maxScale > 1) maxScale = 1;
+    if (targetTime > 0 && (minScale <= 0 || minScale > maxScale)) return false;
+
+    if (upscaler->queries[0] == 0) GL.GenQueries(timerQueries, upscaler->queries);
+    if (upscaler->measuring) {
+        GL.EndQuery(GL_TIME_ELAPSED);
+        upscaler->measuring = false;
+        upscaler->pending++;
+    }
+
+    upscaler->targetTime = targetTime;
+    upscaler->minScale = targetTime > 0 ? minScale : 1;
+    upscaler->maxScale = targetTime > 0 ? maxScale : 1;
+    upscaler->gpuTime = 0;
+    setRenderScale(upscaler, upscaler->maxScale);
+
+    // The render scale changes from frame to frame, so sample the target
+    // with bilinear filtering. The sharp bilinear shader keeps the pixels
+    // sharp regardless.
+    GLenum filter = upscaler->upscaling == Upscaling_Integer && targetTime <= 0 ? GL_NEAREST : GL_LINEAR;
+    glBindTexture(GL_TEXTURE_2D, upscaler->colorTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glViewport(0, 0, upscaler->renderWidth, upscaler->renderHeight);
+    if (targetTime > 0) beginMeasuring(upscaler);
+    return true;
+}
+
+float32 GraphicsGetRenderScale(Window *window) {
+    if (window->upscaler == nil) return 1;
+    return window->upscaler->renderScale;
+}
+
+void GraphicsGetRenderSize(Window *window, int *width, int *height) {
+    if (window->upscaler == nil) {
+        *width = window->width;
+        *height = window->height;
+        return;
+    }
+    *width = window->upscaler->renderWidth;
+    *height = window->upscaler->renderHeight;
+}
+
+void UpscalerPresent(Window *window) {
+    Upscaler *upscaler = window->upscaler;
+    if (upscaler == nil) return;
+    if (upscaler->targetTime > 0) finishMeasuring(upscaler);
+
+    // Work out where the scaled image goes, centered in the window.
+    float32 scaleX = (float32)window->width / upscaler->width;
+    float32 scaleY = (float32)window->height / upscaler->height;
+    float32 scale = scaleX < scaleY ? scaleX : scaleY;
+    if (upscaler->upscaling == Upscaling_Integer) scale = (int)scale;
+    if (scale < 1) scale = 1;
+    int width = (int)(upscaler->width * scale + 0.5f);
+    int height = (int)(upscaler->height * scale + 0.5f);
+    int x = (window->width - width) / 2;
+    int y = (window->height - height) / 2;
+
+    // Only the state this changes is saved, so the game's own state is left
+    // alone for the next frame.
+    GLint program, vertexArray, activeTexture, texture;
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+    GL.ActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+
+    GL.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window->width, window->height);
+    glClearColor(0, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glViewport(x, y, width, height);
+    GL.UseProgram(upscaler->program);
+    GL.Uniform2f(upscaler->sizeLocation, upscaler->renderWidth, upscaler->renderHeight);
+    GL.Uniform2f(upscaler->textureSizeLocation, upscaler->width, upscaler->height);
+    GL.Uniform2f(
+        upscaler->scaleLocation,
+        (float32)width / upscaler->renderWidth,
+        (float32)height / upscaler->renderHeight);
+    GL.BindVertexArray(upscaler->vertexArray);
+    glBindTexture(GL_TEXTURE_2D, upscaler->colorTexture);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    GL.ActiveTexture(activeTexture);
+    GL.BindVertexArray(vertexArray);
+    GL.UseProgram(program);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (blend) glEnable(GL_BLEND);
+    if (scissorTest) glEnable(GL_SCISSOR_TEST);
+    GL.BindFramebuffer(GL_FRAMEBUFFER, upscaler->framebuffer);
+    glViewport(0, 0, upscaler->renderWidth, upscaler->renderHeight);
+    if (upscaler->targetTime > 0) beginMeasuring(upscaler);
+}
+
+#endif  // MINO_NO_GL
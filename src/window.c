@@ -30,15 +30,87 @@ bool MouseJustReleased(Window *window, MouseButton button) {
 }
 
 bool KeyPressed(Window *window, Key key) {
-    return window->keyPressed[key];
+    return KeySetHas(window->keyPressed, key);
 }
 
 bool KeyJustPressed(Window *window, Key key) {
-    return window->keyPressed[key] && window->keyPressed[key] != window->pKeyPressed[key];
+    return KeySetHas(window->keyPressed, key) && KeySetHas(window->pKeyPressed, key) == false;
 }
 
 bool KeyJustReleased(Window *window, Key key) {
-    return window->keyPressed[key] == false && window->keyPressed[key] != window->pKeyPressed[key];
+    return KeySetHas(window->keyPressed, key) == false && KeySetHas(window->pKeyPressed, key);
+}
+
+bool KeySetHas(KeySet set, Key key) {
+    return (set.bits[key / 64] >> (key % 64)) & 1;
+}
+
+void KeySetPut(KeySet *set, Key key, bool value) {
+    uint64 mask = (uint64)1 << (key % 64);
+    if (value) {
+        set->bits[key / 64] |= mask;
+    } else {
+        set->bits[key / 64] &= ~mask;
+    }
+}
+
+void KeySetUpdateModifiers(KeySet *set, Key key) {
+    if (key == Key_LeftCtrl || key == Key_RightCtrl)
+        KeySetPut(set, Key_Ctrl, KeySetHas(*set, Key_LeftCtrl) || KeySetHas(*set, Key_RightCtrl));
+    else if (key == Key_LeftShift || key == Key_RightShift)
+        KeySetPut(set, Key_Shift, KeySetHas(*set, Key_LeftShift) || KeySetHas(*set, Key_RightShift));
+    else if (key == Key_LeftWin || key == Key_RightWin)
+        KeySetPut(set, Key_Win, KeySetHas(*set, Key_LeftWin) || KeySetHas(*set, Key_RightWin));
+    else if (key == Key_LeftAlt || key == Key_RightAlt)
+        KeySetPut(set, Key_Alt, KeySetHas(*set, Key_LeftAlt) || KeySetHas(*set, Key_RightAlt));
+}
+
+bool KeySetEmpty(KeySet set) {
+    uint64 any = 0;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        any |= set.bits[i];
+    }
+    return any == 0;
+}
+
+bool KeySetNext(KeySet *set, Key *key) {
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        uint64 bits = set->bits[i];
+        if (bits == 0) continue;
+        *key = i * 64 + __builtin_ctzll(bits);
+        // Clear the lowest set bit.
+        set->bits[i] = bits & (bits - 1);
+        return true;
+    }
+    return false;
+}
+
+KeySet KeysPressed(Window *window) {
+    return window->keyPressed;
+}
+
+KeySet KeysChanged(Window *window) {
+    KeySet set;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        set.bits[i] = window->keyPressed.bits[i] ^ window->pKeyPressed.bits[i];
+    }
+    return set;
+}
+
+KeySet KeysJustPressed(Window *window) {
+    KeySet set;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        set.bits[i] = window->keyPressed.bits[i] & ~window->pKeyPressed.bits[i];
+    }
+    return set;
+}
+
+KeySet KeysJustReleased(Window *window) {
+    KeySet set;
+    for (int i = 0; i < KEY_SET_WORDS; i++) {
+        set.bits[i] = ~window->keyPressed.bits[i] & window->pKeyPressed.bits[i];
+    }
+    return set;
 }
 
 bool KeyModSet(Window *window, KeyMod modifier) {
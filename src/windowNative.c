@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wchar.h>
 
 // X11 also defines a `Window` type that conflicts with Mino. This hack
@@ -15,18 +16,23 @@
 #define Window MinoWindow
 #endif
 
+#include "damage.h"
+#include "event.h"
+#include "framebuffer.h"
 #include "gamepad.h"
+#include "glLoader.h"
 #include "graphics.h"
 #include "keyboard.h"
 #include "mouse.h"
+#include "record.h"
+#include "snapshot.h"
 #include "types.h"
 #include "utils.h"
 #include "window.h"
 
 static void resetInputState(Window *window) {
-    for (int i = 0; i < Key_Count; i++) {
-        window->pKeyPressed[i] = window->keyPressed[i];
-    }
+    InputQueueClear(&window->events);
+    window->pKeyPressed = window->keyPressed;
     window->pMouseX = window->mouseX;
     window->pMouseY = window->mouseY;
     window->pMousePressed = window->mousePressed;
@@ -46,6 +52,47 @@ static void resetInputState(Window *window) {
     }
 }
 
+// `pushGamepadChanges` queues an event for every button and axis that changed
+// since `buttons` and `axes` were recorded.
+static void pushGamepadChanges(Window *window, Gamepad *gamepad, uint32 buttons, const float32 *axes, int64 time) {
+    uint32 changed = buttons ^ gamepad->buttons;
+    for (GamepadButton button = 0; changed != 0; button++, changed >>= 1) {
+        if ((changed & 1) == 0) continue;
+        InputQueuePush(&window->events, (InputEvent){
+            .type = bitSet(gamepad->buttons, button) ? InputEventType_GamepadPress : InputEventType_GamepadRelease,
+            .time = time,
+            .gamepad = {.playerID = gamepad->playerID, .button = button},
+        });
+    }
+    for (GamepadAxis axis = 0; axis < GamepadAxis_Count; axis++) {
+        if (axes[axis] == gamepad->axes[axis]) continue;
+        InputQueuePush(&window->events, (InputEvent){
+            .type = InputEventType_GamepadAxis,
+            .time = time,
+            .gamepad = {.playerID = gamepad->playerID, .axis = axis, .value = gamepad->axes[axis]},
+        });
+    }
+}
+
+#if !defined(MINO_NO_GL)
+
+// `extensionSupported` checks whether `name` is one of the space separated
+// extension names in `extensions`.
+static bool extensionSupported(const char *extensions, const char *name) {
+    if (extensions == nil) return false;
+    int nameLen = strlen(name);
+    const char *start = extensions;
+    while ((start = strstr(start, name)) != nil) {
+        bool startsWord = start == extensions || start[-1] == ' ';
+        bool endsWord = start[nameLen] == ' ' || start[nameLen] == '\0';
+        if (startsWord && endsWord) return true;
+        start += nameLen;
+    }
+    return false;
+}
+
+#endif  // MINO_NO_GL
+
 #if defined(PLATFORM_Windows)
 
 #include <windows.h>
@@ -59,30 +106,80 @@ struct WindowNative {
     HWND windowHandle;
     HGLRC glContext;
     int64 lastTick;
+    // `messageTimeOffset` converts message timestamps to `WindowTimeNano` time.
+    int64 messageTimeOffset;
+
+    // `headless` windows are never shown and take their input from `script`.
+    bool headless;
+    const InputScript *script;
+    int scriptIndex;
+    int64 frame;
+
+    // `swapInterval` is the last interval set with `GraphicsSetSwapInterval`.
+    int swapInterval;
+    // `presented` is set once the frame has been shown, so `WindowUpdate`
+    // knows whether it still has to.
+    bool presented;
+
+    // `graphics` is the context requested in `WindowConfig`, with anything
+    // the driver can't do turned off.
+    GraphicsConfig graphics;
 };
 
 const Key WinKey2MinoKey[256] = {['A'] = Key_A, ['B'] = Key_B, ['C'] = Key_C, ['D'] = Key_D, ['E'] = Key_E, ['F'] = Key_F, ['G'] = Key_G, ['H'] = Key_H, ['I'] = Key_I, ['J'] = Key_J, ['K'] = Key_K, ['L'] = Key_L, ['M'] = Key_M, ['N'] = Key_N, ['O'] = Key_O, ['P'] = Key_P, ['Q'] = Key_Q, ['R'] = Key_R, ['S'] = Key_S, ['T'] = Key_T, ['U'] = Key_U, ['V'] = Key_V, ['W'] = Key_W, ['X'] = Key_X, ['Y'] = Key_Y, ['Z'] = Key_Z, [VK_LMENU] = Key_LeftAlt, [VK_RMENU] = Key_RightAlt, [VK_DOWN] = Key_DownArrow, [VK_LEFT] = Key_LeftArrow, [VK_RIGHT] = Key_RightArrow, [VK_UP] = Key_UpArrow, [VK_OEM_3] = Key_Tilde, [VK_OEM_5] = Key_Backslash, [VK_BACK] = Key_Backspace, [VK_OEM_4] = Key_LeftBracket, [VK_OEM_6] = Key_RightBracket, [VK_CAPITAL] = Key_CapsLock, [VK_OEM_COMMA] = Key_Comma, [VK_APPS] = Key_Menu, [VK_LCONTROL] = Key_LeftCtrl, [VK_RCONTROL] = Key_RightCtrl, [VK_DELETE] = Key_Delete, ['0'] = Key_0, ['1'] = Key_1, ['2'] = Key_2, ['3'] = Key_3, ['4'] = Key_4, ['5'] = Key_5, ['6'] = Key_6, ['7'] = Key_7, ['8'] = Key_8, ['9'] = Key_9, [VK_END] = Key_End, [VK_RETURN] = Key_Enter, [VK_OEM_PLUS] = Key_Equal, [VK_ESCAPE] = Key_Escape, [VK_F1] = Key_F1, [VK_F2] = Key_F2, [VK_F3] = Key_F3, [VK_F4] = Key_F4, [VK_F5] = Key_F5, [VK_F6] = Key_F6, [VK_F7] = Key_F7, [VK_F8] = Key_F8, [VK_F9] = Key_F9, [VK_F10] = Key_F10, [VK_F11] = Key_F11, [VK_F12] = Key_F12, [VK_HOME] = Key_Home, [VK_INSERT] = Key_Insert, [VK_LWIN] = Key_LeftWin, [VK_RWIN] = Key_RightWin, [VK_OEM_MINUS] = Key_Minus, [VK_NUMLOCK] = Key_NumLock, [VK_NUMPAD0] = Key_NumPad0, [VK_NUMPAD1] = Key_NumPad1, [VK_NUMPAD2] = Key_NumPad2, [VK_NUMPAD3] = Key_NumPad3, [VK_NUMPAD4] = Key_NumPad4, [VK_NUMPAD5] = Key_NumPad5, [VK_NUMPAD6] = Key_NumPad6, [VK_NUMPAD7] = Key_NumPad7, [VK_NUMPAD8] = Key_NumPad8, [VK_NUMPAD9] = Key_NumPad9, [VK_ADD] = Key_NumPadAdd, [VK_DECIMAL] = Key_NumPadDecimal, [VK_DIVIDE] = Key_NumPadDivide, [VK_SEPARATOR] = Key_NumPadEnter, /*Key_NP_EQUAL*/[VK_MULTIPLY] = Key_NumPadMultiply, [VK_SUBTRACT] = Key_NumPadSubtract, [VK_NEXT] = Key_PageDown, [VK_PRIOR] = Key_PageUp, [VK_PAUSE] = Key_Pause, [VK_OEM_PERIOD] = Key_Period, [VK_SNAPSHOT] = Key_PrintScreen, [VK_OEM_7] = Key_Quote, [VK_SCROLL] = Key_ScrollLock, [VK_OEM_1] = Key_Semicolon, [VK_LSHIFT] = Key_LeftShift, [VK_RSHIFT] = Key_RightShift, [VK_OEM_2] = Key_Slash, [VK_SPACE] = Key_Space, [VK_TAB] = Key_Tab, [VK_MENU] = Key_Alt, [VK_CONTROL] = Key_Ctrl, [VK_SHIFT] = Key_Shift /*, Key_WIN*/};
 const int MinoKey2WinKey[Key_Count] = {[Key_A] = 'A', [Key_B] = 'B', [Key_C] = 'C', [Key_D] = 'D', [Key_E] = 'E', [Key_F] = 'F', [Key_G] = 'G', [Key_H] = 'H', [Key_I] = 'I', [Key_J] = 'J', [Key_K] = 'K', [Key_L] = 'L', [Key_M] = 'M', [Key_N] = 'N', [Key_O] = 'O', [Key_P] = 'P', [Key_Q] = 'Q', [Key_R] = 'R', [Key_S] = 'S', [Key_T] = 'T', [Key_U] = 'U', [Key_V] = 'V', [Key_W] = 'W', [Key_X] = 'X', [Key_Y] = 'Y', [Key_Z] = 'Z', [Key_LeftAlt] = VK_LMENU, [Key_RightAlt] = VK_RMENU, [Key_DownArrow] = VK_DOWN, [Key_LeftArrow] = VK_LEFT, [Key_RightArrow] = VK_RIGHT, [Key_UpArrow] = VK_UP, [Key_Tilde] = VK_OEM_3, [Key_Backslash] = VK_OEM_5, [Key_Backspace] = VK_BACK, [Key_LeftBracket] = VK_OEM_4, [Key_RightBracket] = VK_OEM_6, [Key_CapsLock] = VK_CAPITAL, [Key_Comma] = VK_OEM_COMMA, [Key_Menu] = VK_APPS, [Key_LeftCtrl] = VK_LCONTROL, [Key_RightCtrl] = VK_RCONTROL, [Key_Delete] = VK_DELETE, [Key_0] = '0', [Key_1] = '1', [Key_2] = '2', [Key_3] = '3', [Key_4] = '4', [Key_5] = '5', [Key_6] = '6', [Key_7] = '7', [Key_8] = '8', [Key_9] = '9', [Key_End] = VK_END, [Key_Enter] = VK_RETURN, [Key_Equal] = VK_OEM_PLUS, [Key_Escape] = VK_ESCAPE, [Key_F1] = VK_F1, [Key_F2] = VK_F2, [Key_F3] = VK_F3, [Key_F4] = VK_F4, [Key_F5] = VK_F5, [Key_F6] = VK_F6, [Key_F7] = VK_F7, [Key_F8] = VK_F8, [Key_F9] = VK_F9, [Key_F10] = VK_F10, [Key_F11] = VK_F11, [Key_F12] = VK_F12, [Key_Home] = VK_HOME, [Key_Insert] = VK_INSERT, [Key_LeftWin] = VK_LWIN, [Key_RightWin] = VK_RWIN, [Key_Minus] = VK_OEM_MINUS, [Key_NumLock] = VK_NUMLOCK, [Key_NumPad0] = VK_NUMPAD0, [Key_NumPad1] = VK_NUMPAD1, [Key_NumPad2] = VK_NUMPAD2, [Key_NumPad3] = VK_NUMPAD3, [Key_NumPad4] = VK_NUMPAD4, [Key_NumPad5] = VK_NUMPAD5, [Key_NumPad6] = VK_NUMPAD6, [Key_NumPad7] = VK_NUMPAD7, [Key_NumPad8] = VK_NUMPAD8, [Key_NumPad9] = VK_NUMPAD9, [Key_NumPadAdd] = VK_ADD, [Key_NumPadDecimal] = VK_DECIMAL, [Key_NumPadDivide] = VK_DIVIDE, [Key_NumPadEnter] = VK_SEPARATOR, /*Key_NP_EQUAL*/[Key_NumPadMultiply] = VK_MULTIPLY, [Key_NumPadSubtract] = VK_SUBTRACT, [Key_PageDown] = VK_NEXT, [Key_PageUp] = VK_PRIOR, [Key_Pause] = VK_PAUSE, [Key_Period] = VK_OEM_PERIOD, [Key_PrintScreen] = VK_SNAPSHOT, [Key_Quote] = VK_OEM_7, [Key_ScrollLock] = VK_SCROLL, [Key_Semicolon] = VK_OEM_1, [Key_LeftShift] = VK_LSHIFT, [Key_RightShift] = VK_RSHIFT, [Key_Slash] = VK_OEM_2, [Key_Space] = VK_SPACE, [Key_Tab] = VK_TAB, [Key_Alt] = VK_MENU, [Key_Ctrl] = VK_CONTROL, [Key_Shift] = VK_SHIFT /*, Key_WIN*/};
 
+static int64 messageTime(Window *window) {
+    return InputTimeFromMillis(&window->native->messageTimeOffset, GetMessageTime());
+}
+
+static void setMouseButton(Window *window, MouseButton button, bool pressed, LPARAM lParam) {
+    if (pressed) {
+        window->mousePressed = (uint8)setBit(window->mousePressed, button);
+    } else {
+        window->mousePressed = (uint8)unsetBit(window->mousePressed, button);
+    }
+    InputQueuePush(&window->events, (InputEvent){
+        .type = pressed ? InputEventType_MousePress : InputEventType_MouseRelease,
+        .time = messageTime(window),
+        .mouse = {.button = button, .x = (int16)LOWORD(lParam), .y = (int16)HIWORD(lParam)},
+    });
+}
+
 static LRESULT CALLBACK WindowProcedure(HWND windowHandle, UINT msg, WPARAM wParam,
     LPARAM lParam) {
     Window *window = (Window *)GetWindowLongPtr(windowHandle, GWLP_USERDATA);
 
+    // Messages can arrive before the window is attached (while it's still
+    // being created) or for windows that are never attached, like the one
+    // used to load WGL extensions.
+    if (window == nil) return DefWindowProc(windowHandle, msg, wParam, lParam);
+
+    // Input comes from the recording while replaying so the real keyboard and
+    // mouse are ignored.
+    bool inputMessage =
+        (msg >= WM_KEYFIRST && msg <= WM_KEYLAST) ||
+        (msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST);
+    if (inputMessage && InputRecordingReplaying(window)) {
+        return 0;
+    }
+
     switch (msg) {
         case WM_PAINT: {
+            // Frames are shown by `GraphicsPresent` as soon as they're drawn,
+            // so there's nothing to paint here. The next frame covers anything
+            // that was uncovered.
             PAINTSTRUCT ps;
-            HDC deviceContext = GetDC(windowHandle);
             BeginPaint(windowHandle, &ps);
-            SwapBuffers(deviceContext);
             EndPaint(windowHandle, &ps);
-            ReleaseDC(windowHandle, deviceContext);
         } break;
 
         case WM_SIZE: {
             window->width = LOWORD(lParam);
             window->height = HIWORD(lParam);
 
-            if (window->native->glContext) {
+#if !defined(MINO_NO_GL)
+            if (window->native->glContext && window->upscaler == nil) {
                 GraphicsMakeCurrent(window);
 
                 glViewport(
@@ -90,6 +187,7 @@ static LRESULT CALLBACK WindowProcedure(HWND windowHandle, UINT msg, WPARAM wPar
                     window->width,
                     window->height);
             }
+#endif
         } break;
 
         case WM_CLOSE: {
@@ -97,54 +195,74 @@ static LRESULT CALLBACK WindowProcedure(HWND windowHandle, UINT msg, WPARAM wPar
         } break;
 
         case WM_LBUTTONDOWN: {
-            window->mousePressed = (uint8)setBit(window->mousePressed, MouseButton_Left);
+            setMouseButton(window, MouseButton_Left, true, lParam);
         } break;
 
         case WM_LBUTTONUP: {
-            window->mousePressed = (uint8)unsetBit(window->mousePressed, MouseButton_Left);
+            setMouseButton(window, MouseButton_Left, false, lParam);
         } break;
 
         case WM_RBUTTONDOWN: {
-            window->mousePressed = (uint8)setBit(window->mousePressed, MouseButton_Right);
+            setMouseButton(window, MouseButton_Right, true, lParam);
         } break;
 
         case WM_RBUTTONUP: {
-            window->mousePressed = (uint8)unsetBit(window->mousePressed, MouseButton_Right);
+            setMouseButton(window, MouseButton_Right, false, lParam);
         } break;
 
         case WM_MBUTTONDOWN: {
-            window->mousePressed = (uint8)setBit(window->mousePressed, MouseButton_Middle);
+            setMouseButton(window, MouseButton_Middle, true, lParam);
         } break;
 
         case WM_MBUTTONUP: {
-            window->mousePressed = (uint8)unsetBit(window->mousePressed, MouseButton_Middle);
+            setMouseButton(window, MouseButton_Middle, false, lParam);
         } break;
 
         case WM_XBUTTONDOWN: {
-            window->mousePressed = (uint8)setBit(window->mousePressed, (HIWORD(wParam) == XBUTTON1) ? MouseButton_Back : MouseButton_Forward);
+            setMouseButton(window, (HIWORD(wParam) == XBUTTON1) ? MouseButton_Back : MouseButton_Forward, true, lParam);
         } break;
 
         case WM_XBUTTONUP: {
-            window->mousePressed = (uint8)unsetBit(window->mousePressed, (HIWORD(wParam) == XBUTTON1) ? MouseButton_Back : MouseButton_Forward);
+            setMouseButton(window, (HIWORD(wParam) == XBUTTON1) ? MouseButton_Back : MouseButton_Forward, false, lParam);
         } break;
 
         case WM_MOUSEMOVE: {
             window->mouseX = LOWORD(lParam);
             window->mouseY = HIWORD(lParam);
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_MouseMove,
+                .time = messageTime(window),
+                .mouse = {.x = window->mouseX, .y = window->mouseY},
+            });
         } break;
 
         case WM_MOUSEWHEEL: {
             window->scrollY += GET_WHEEL_DELTA_WPARAM(wParam);
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_Scroll,
+                .time = messageTime(window),
+                .scroll = {.y = GET_WHEEL_DELTA_WPARAM(wParam)},
+            });
         } break;
 
         case WM_MOUSEHWHEEL: {
             window->scrollX += GET_WHEEL_DELTA_WPARAM(wParam);
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_Scroll,
+                .time = messageTime(window),
+                .scroll = {.x = GET_WHEEL_DELTA_WPARAM(wParam)},
+            });
         } break;
 
         case WM_KEYDOWN:
         case WM_KEYUP: {
             Key key = WinKey2MinoKey[wParam];
-            window->keyPressed[key] = (msg == WM_KEYDOWN);
+            KeySetPut(&window->keyPressed, key, msg == WM_KEYDOWN);
+            InputQueuePush(&window->events, (InputEvent){
+                .type = msg == WM_KEYDOWN ? InputEventType_KeyPress : InputEventType_KeyRelease,
+                .time = messageTime(window),
+                .key = key,
+            });
 
             // Check modifiers
             window->KeyMod =
@@ -159,6 +277,11 @@ static LRESULT CALLBACK WindowProcedure(HWND windowHandle, UINT msg, WPARAM wPar
 
         case WM_CHAR: {
             window->keyChar = wParam;
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_Char,
+                .time = messageTime(window),
+                .character = window->keyChar,
+            });
         } break;
 
         case WM_ACTIVATEAPP: {
@@ -178,15 +301,18 @@ static LRESULT CALLBACK WindowProcedure(HWND windowHandle, UINT msg, WPARAM wPar
 
 bool WindowInit(Window *window, WindowConfig config) {
     HINSTANCE instance = GetModuleHandle(nil);
+    // `CS_OWNDC` gives the window the same device context for its whole
+    // life, so checking whether its context is current is a cheap compare.
     WNDCLASSEX windowClass = {
         .cbSize = sizeof(WNDCLASSEX),
-        .style = CS_VREDRAW | CS_HREDRAW,
+        .style = CS_VREDRAW | CS_HREDRAW | CS_OWNDC,
         .lpfnWndProc = WindowProcedure,
         .hInstance = instance,
         .lpszClassName = "Mino Window Class"};
     RegisterClassEx(&windowClass);
 
     WindowNative *native = window->native = allocate(WindowNative);
+    native->graphics = config.graphics;
 
     native->windowHandle = CreateWindowEx(
         WS_EX_CLIENTEDGE,
@@ -209,6 +335,17 @@ bool WindowInit(Window *window, WindowConfig config) {
     }
 
     SetWindowLongPtr(native->windowHandle, GWLP_USERDATA, (LONG_PTR)window);
+
+    // WGL needs a window to create a context so headless windows still have
+    // one, it just never gets shown.
+    if (config.headless) {
+        native->headless = true;
+        native->script = config.inputScript;
+        window->width = config.width;
+        window->height = config.height;
+        return true;
+    }
+
     ShowWindow(native->windowHandle, SW_NORMAL);
     UpdateWindow(native->windowHandle);
 
@@ -223,11 +360,23 @@ static void updateGamepads(Window *window) {
 
     for (int i = 0; i < window->gamepads.len; i++) {
         gamepad = GamepadListGet(&window->gamepads, i);
+        bool wasConnected = gamepad->connected;
         gamepad->connected = XInputGetState(i, &xInputState) == ERROR_SUCCESS;
+        if (gamepad->connected != wasConnected) {
+            InputQueuePush(&window->events, (InputEvent){
+                .type = gamepad->connected ? InputEventType_GamepadConnect : InputEventType_GamepadDisconnect,
+                .time = WindowTimeNano(),
+                .gamepad = {.playerID = gamepad->playerID},
+            });
+        }
         if (gamepad->connected == false) {
             continue;
         }
 
+        uint32 buttons = gamepad->buttons;
+        float32 axes[GamepadAxis_Count];
+        copy(gamepad->axes, axes, sizeof(axes));
+
         for (int j = 0; j < (int)len(MinoGamepadButton2XinputButton, int); j++) {
             int XinputButton = MinoGamepadButton2XinputButton[j];
             if ((xInputState.Gamepad.wButtons & XinputButton) == XinputButton) {
@@ -251,6 +400,8 @@ static void updateGamepads(Window *window) {
             gamepad->buttons = (uint32)unsetBit(gamepad->buttons, GamepadButton_R2);
         };
 
+        pushGamepadChanges(window, gamepad, buttons, axes, WindowTimeNano());
+
         XINPUT_VIBRATION vibrations = {
             .wLeftMotorSpeed = (uint16)(gamepad->leftMotor * 0xFFFF),
             .wRightMotorSpeed = (uint16)(gamepad->rightMotor * 0xFFFF),
@@ -261,8 +412,29 @@ static void updateGamepads(Window *window) {
 
 bool WindowUpdate(Window *window) {
     resetInputState(window);
-    updateGamepads(window);
+    bool replaying = InputRecordingReplaying(window);
+    window->stats.controllerTime = 0;
+
+    // Show the frame first unless the game already did with
+    // `GraphicsPresent`. Either way input is read after the swap, which may
+    // have waited for vsync, so it's as fresh as possible for the next frame.
+#if !defined(MINO_NO_GL)
+    if (window->renderThread == nil && window->native->presented == false) GraphicsPresent(window);
+#endif
+    window->native->presented = false;
+
+    int64 begin = WindowTimeNano();
+    if (window->native->headless) {
+        if (replaying == false) {
+            InputScriptPlay(window, window->native->script, &window->native->scriptIndex, window->native->frame);
+        }
+        window->native->frame++;
+    } else if (replaying == false) {
+        updateGamepads(window);
+        window->stats.controllerTime = WindowTimeNano() - begin;
+    }
 
+    begin = WindowTimeNano();
     MSG message;
     while (PeekMessage(&message, nil, 0, 0, PM_REMOVE)) {
         if (message.message == WM_QUIT) {
@@ -271,11 +443,26 @@ bool WindowUpdate(Window *window) {
         TranslateMessage(&message);
         DispatchMessage(&message);
     }
-    InvalidateRect(window->native->windowHandle, nil, false);
+    window->stats.eventTime = WindowTimeNano() - begin;
+    InputRecordingUpdate(window);
     return true;
 }
 
+bool WindowWaitEvents(Window *window, int64 timeout) {
+    if (window->native->headless) return WindowUpdate(window);
+
+    DWORD milliseconds = INFINITE;
+    if (timeout >= 0) milliseconds = (DWORD)((timeout + 999999) / 1000000);
+    MsgWaitForMultipleObjects(0, nil, false, milliseconds, QS_ALLINPUT);
+    return WindowUpdate(window);
+}
+
+void WindowLatestInput(Window *window, InputSnapshot *snapshot) {
+    InputSnapshotCapture(window, snapshot);
+}
+
 void WindowClose(Window *window) {
+    WindowStopRecording(window);
     GamepadListFree(&window->gamepads);
 
     if (window->native == nil) return;
@@ -289,84 +476,427 @@ void WindowClose(Window *window) {
 }
 
 int64 WindowTime() {
+    return WindowTimeNano() / 1000000;
+}
+
+int64 WindowTimeNano() {
     LARGE_INTEGER frequency, count;
     QueryPerformanceFrequency(&frequency);
     QueryPerformanceCounter(&count);
-    return (int64)(count.QuadPart * 1000.0 / frequency.QuadPart);
+    // Split the conversion so `count * 1000000000` doesn't overflow after the
+    // computer has been on for a while.
+    int64 seconds = count.QuadPart / frequency.QuadPart;
+    int64 remainder = count.QuadPart % frequency.QuadPart;
+    return seconds * 1000000000 + remainder * 1000000000 / frequency.QuadPart;
 }
 
 void WindowSleep(int64 milliseconds) {
     Sleep(milliseconds);
 }
 
+void WindowSleepUntil(int64 deadline) {
+    int64 remaining = deadline - WindowTimeNano();
+    if (remaining <= 0) return;
+    Sleep((DWORD)(remaining / 1000000));
+}
+
+#if !defined(MINO_NO_GL)
+
+typedef const char *(WINAPI *GetExtensionsStringProc)(void);
+typedef BOOL(WINAPI *SwapIntervalProc)(int interval);
+typedef int(WINAPI *GetSwapIntervalProc)(void);
+
+// `wglExtensionSupported` checks for a WGL extension. The current context must
+// belong to the window.
+static bool wglExtensionSupported(const char *name) {
+    GetExtensionsStringProc getExtensions = (GetExtensionsStringProc)wglGetProcAddress("wglGetExtensionsStringEXT");
+    if (getExtensions == nil) return false;
+    return extensionSupported(getExtensions(), name);
+}
+
+// `legacyPixelFormat` describes the pixel format used when WGL_ARB_pixel_format
+// isn't available.
+static const PIXELFORMATDESCRIPTOR legacyPixelFormat = {
+    .nSize = sizeof(PIXELFORMATDESCRIPTOR),
+    .nVersion = 1,
+    .dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
+    .iPixelType = PFD_TYPE_RGBA,
+    .cColorBits = 32,
+
+    .cRedBits = 8,
+    .cRedShift = 16,
+    .cAccumRedBits = 8,
+
+    .cGreenBits = 8,
+    .cGreenShift = 8,
+    .cAccumGreenBits = 8,
+
+    .cBlueBits = 8,
+    .cBlueShift = 0,
+    .cAccumBlueBits = 8,
+
+    .cAlphaBits = 8,
+    .cAlphaShift = 24,
+    .cAccumAlphaBits = 8,
+
+    .cDepthBits = 8,
+    .cStencilBits = 8,
+};
+
+// `WGLExtensions` holds the WGL functions needed to create a modern context.
+// They can only be loaded while some context is current.
+typedef struct WGLExtensions {
+    PFNWGLCHOOSEPIXELFORMATARBPROC choosePixelFormat;
+    PFNWGLCREATECONTEXTATTRIBSARBPROC createContextAttribs;
+    bool profile, noError, srgb, multisample;
+} WGLExtensions;
+
+// `loadWGLExtensions` creates a throwaway window and context to load the WGL
+// extension functions. A window's pixel format can only be set once, so this
+// can't be done with the real window.
+static WGLExtensions loadWGLExtensions(HINSTANCE instance, const char *className) {
+    WGLExtensions extensions = {0};
+    HWND dummyWindow = CreateWindowEx(0, className, "", 0, 0, 0, 1, 1, nil, nil, instance, nil);
+    if (dummyWindow == nil) return extensions;
+
+    HDC deviceContext = GetDC(dummyWindow);
+    int pixelFormat = ChoosePixelFormat(deviceContext, &legacyPixelFormat);
+    HGLRC dummyContext = nil;
+    if (pixelFormat != 0 && SetPixelFormat(deviceContext, pixelFormat, &legacyPixelFormat)) {
+        dummyContext = wglCreateContext(deviceContext);
+    }
+    if (dummyContext != nil && wglMakeCurrent(deviceContext, dummyContext)) {
+        extensions.choosePixelFormat = (PFNWGLCHOOSEPIXELFORMATARBPROC)wglGetProcAddress("wglChoosePixelFormatARB");
+        extensions.createContextAttribs = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+        extensions.profile = wglExtensionSupported("WGL_ARB_create_context_profile");
+        extensions.noError = wglExtensionSupported("WGL_ARB_create_context_no_error");
+        extensions.srgb = wglExtensionSupported("WGL_ARB_framebuffer_sRGB") || wglExtensionSupported("WGL_EXT_framebuffer_sRGB");
+        extensions.multisample = wglExtensionSupported("WGL_ARB_multisample");
+        wglMakeCurrent(nil, nil);
+    }
+    if (dummyContext != nil) wglDeleteContext(dummyContext);
+    ReleaseDC(dummyWindow, deviceContext);
+    DestroyWindow(dummyWindow);
+    return extensions;
+}
+
+// `choosePixelFormat` picks the pixel format that best matches `graphics`,
+// turning off multisampling and sRGB if they aren't available.
+static int choosePixelFormat(HDC deviceContext, WGLExtensions *extensions, GraphicsConfig *graphics) {
+    if (extensions->choosePixelFormat == nil) {
+        graphics->samples = 0;
+        graphics->srgb = false;
+        return ChoosePixelFormat(deviceContext, &legacyPixelFormat);
+    }
+    if (extensions->multisample == false) graphics->samples = 0;
+    if (extensions->srgb == false) graphics->srgb = false;
+
+    while (true) {
+        int attributes[32];
+        int count = 0;
+        int base[] = {
+            WGL_DRAW_TO_WINDOW_ARB, true,
+            WGL_SUPPORT_OPENGL_ARB, true,
+            WGL_DOUBLE_BUFFER_ARB, true,
+            WGL_PIXEL_TYPE_ARB, WGL_TYPE_RGBA_ARB,
+            WGL_COLOR_BITS_ARB, 32,
+            WGL_DEPTH_BITS_ARB, 24,
+            WGL_STENCIL_BITS_ARB, 8,
+        };
+        for (int i = 0; i < (int)len(base, int); i++) attributes[count++] = base[i];
+        if (graphics->samples > 0) {
+            attributes[count++] = WGL_SAMPLE_BUFFERS_ARB;
+            attributes[count++] = 1;
+            attributes[count++] = WGL_SAMPLES_ARB;
+            attributes[count++] = graphics->samples;
+        }
+        if (graphics->srgb) {
+            attributes[count++] = WGL_FRAMEBUFFER_SRGB_CAPABLE_ARB;
+            attributes[count++] = true;
+        }
+        attributes[count++] = 0;
+
+        int pixelFormat = 0;
+        UINT formatCount = 0;
+        if (extensions->choosePixelFormat(deviceContext, attributes, nil, 1, &pixelFormat, &formatCount) && formatCount > 0) {
+            return pixelFormat;
+        }
+
+        if (graphics->samples > 0) {
+            graphics->samples = 0;
+        } else if (graphics->srgb) {
+            graphics->srgb = false;
+        } else {
+            return 0;
+        }
+    }
+}
+
+// `createContext` creates a context with the settings in `graphics`. This
+// returns nil if the driver can't create that kind of context.
+static HGLRC createContext(HDC deviceContext, WGLExtensions *extensions, GraphicsConfig *graphics) {
+    if (extensions->createContextAttribs == nil) {
+        if (graphics->majorVersion > 0 || graphics->profile != GraphicsProfile_Compatibility) return nil;
+        graphics->noError = false;
+        return wglCreateContext(deviceContext);
+    }
+
+    int attributes[16];
+    int count = 0;
+    if (graphics->majorVersion > 0) {
+        attributes[count++] = WGL_CONTEXT_MAJOR_VERSION_ARB;
+        attributes[count++] = graphics->majorVersion;
+        attributes[count++] = WGL_CONTEXT_MINOR_VERSION_ARB;
+        attributes[count++] = graphics->minorVersion;
+    }
+    if (extensions->profile) {
+        attributes[count++] = WGL_CONTEXT_PROFILE_MASK_ARB;
+        attributes[count++] = graphics->profile == GraphicsProfile_Core
+            ? WGL_CONTEXT_CORE_PROFILE_BIT_ARB
+            : WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB;
+    } else if (graphics->profile == GraphicsProfile_Core) {
+        return nil;
+    }
+    int noErrorAttribute = count;
+    if (graphics->noError && extensions->noError) {
+        attributes[count++] = WGL_CONTEXT_OPENGL_NO_ERROR_ARB;
+        attributes[count++] = true;
+    }
+    attributes[count++] = 0;
+
+    HGLRC glContext = extensions->createContextAttribs(deviceContext, nil, attributes);
+    if (glContext == nil && count - 1 > noErrorAttribute) {
+        attributes[noErrorAttribute] = 0;
+        glContext = extensions->createContextAttribs(deviceContext, nil, attributes);
+    }
+    if (attributes[noErrorAttribute] == 0) graphics->noError = false;
+    return glContext;
+}
+
 bool GraphicsInit(Window *window) {
-    if (window->native->glContext) {
+    WindowNative *native = window->native;
+    if (native->glContext) {
         return false;
     }
-    HDC deviceContext = GetDC(window->native->windowHandle);
-    PIXELFORMATDESCRIPTOR pixelFormatDescriptor = {
-        .nSize = sizeof(PIXELFORMATDESCRIPTOR),
-        .nVersion = 1,
-        .dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
-        .iPixelType = PFD_TYPE_RGBA,
-        .cColorBits = 32,
-
-        .cRedBits = 8,
-        .cRedShift = 16,
-        .cAccumRedBits = 8,
-
-        .cGreenBits = 8,
-        .cGreenShift = 8,
-        .cAccumGreenBits = 8,
-
-        .cBlueBits = 8,
-        .cBlueShift = 0,
-        .cAccumBlueBits = 8,
-
-        .cAlphaBits = 8,
-        .cAlphaShift = 24,
-        .cAccumAlphaBits = 8,
-
-        .cDepthBits = 8,
-        .cStencilBits = 8,
-    };
 
-    int pixelFormat = ChoosePixelFormat(deviceContext, &pixelFormatDescriptor);
+    char className[256];
+    GetClassName(native->windowHandle, className, sizeof(className));
+    WGLExtensions extensions = loadWGLExtensions(GetModuleHandle(nil), className);
+
+    HDC deviceContext = GetDC(native->windowHandle);
+    int pixelFormat = choosePixelFormat(deviceContext, &extensions, &native->graphics);
     if (pixelFormat == 0) {
-        ReleaseDC(window->native->windowHandle, deviceContext);
+        ReleaseDC(native->windowHandle, deviceContext);
         return false;
     }
 
+    PIXELFORMATDESCRIPTOR pixelFormatDescriptor;
+    DescribePixelFormat(deviceContext, pixelFormat, sizeof(PIXELFORMATDESCRIPTOR), &pixelFormatDescriptor);
     if (SetPixelFormat(deviceContext, pixelFormat, &pixelFormatDescriptor) == false) {
-        ReleaseDC(window->native->windowHandle, deviceContext);
+        ReleaseDC(native->windowHandle, deviceContext);
         return false;
     }
 
-    DescribePixelFormat(deviceContext, pixelFormat, sizeof(PIXELFORMATDESCRIPTOR), &pixelFormatDescriptor);
-
-    window->native->glContext = wglCreateContext(deviceContext);
-    if (window->native->glContext == nil) {
-        ReleaseDC(window->native->windowHandle, deviceContext);
+    native->glContext = createContext(deviceContext, &extensions, &native->graphics);
+    if (native->glContext == nil) {
+        ReleaseDC(native->windowHandle, deviceContext);
         return false;
     }
-    ReleaseDC(window->native->windowHandle, deviceContext);
+    wglMakeCurrent(deviceContext, native->glContext);
+    ReleaseDC(native->windowHandle, deviceContext);
 
+    native->swapInterval = 1;
     glEnable(GL_DEPTH_TEST);
+    if (native->graphics.srgb) glEnable(GL_FRAMEBUFFER_SRGB);
+    GLLoad(window);
     return true;
 }
 
+void *GraphicsGetProcAddress(Window *window, const char *name) {
+    (void)window;
+    // wglGetProcAddress only finds extension functions and may return small
+    // numbers instead of nil when it fails. OpenGL 1.1 functions come straight
+    // from opengl32.dll.
+    void *function = (void *)wglGetProcAddress(name);
+    INT_PTR value = (INT_PTR)function;
+    if (value == 0 || value == 1 || value == 2 || value == 3 || value == -1) {
+        function = (void *)GetProcAddress(GetModuleHandle("opengl32.dll"), name);
+    }
+    return function;
+}
+
+bool GraphicsSetSwapInterval(Window *window, int interval) {
+    if (window->native->glContext == nil) return false;
+    GraphicsMakeCurrent(window);
+
+    SwapIntervalProc swapInterval = (SwapIntervalProc)wglGetProcAddress("wglSwapIntervalEXT");
+    if (swapInterval == nil) return false;
+
+    bool exact = interval >= 0 || wglExtensionSupported("WGL_EXT_swap_control_tear");
+    if (exact == false) interval = -interval;
+    if (swapInterval(interval) == false) return false;
+    window->native->swapInterval = interval;
+    return exact;
+}
+
+int GraphicsGetSwapInterval(Window *window) {
+    if (window->native->glContext == nil) return window->native->swapInterval;
+    GraphicsMakeCurrent(window);
+
+    GetSwapIntervalProc getSwapInterval = (GetSwapIntervalProc)wglGetProcAddress("wglGetSwapIntervalEXT");
+    if (getSwapInterval == nil) return window->native->swapInterval;
+    return getSwapInterval();
+}
+
+void GraphicsAddDamage(Window *window, int x, int y, int width, int height) {
+    // WGL can't present part of a window, so every frame is shown in full.
+    (void)window;
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+}
+
 void GraphicsClose(Window *window) {
     if (window->native->glContext == nil) return;
+    UpscalerClose(window);
     wglDeleteContext(window->native->glContext);
     window->native->glContext = nil;
 }
 
+// `makeCurrent` binds the window's context to `deviceContext` unless it
+// already is. Asking what is current doesn't have to go through the driver,
+// unlike binding, so this saves a call into it on every frame.
+static void makeCurrent(Window *window, HDC deviceContext) {
+    if (wglGetCurrentContext() == window->native->glContext && wglGetCurrentDC() == deviceContext) return;
+    wglMakeCurrent(deviceContext, window->native->glContext);
+}
+
 void GraphicsMakeCurrent(Window *window) {
     HDC deviceContext = GetDC(window->native->windowHandle);
-    wglMakeCurrent(deviceContext, window->native->glContext);
+    makeCurrent(window, deviceContext);
     ReleaseDC(window->native->windowHandle, deviceContext);
 }
 
+static int64 swapBuffers(Window *window) {
+    WindowNative *native = window->native;
+    if (native->glContext == nil) return 0;
+
+    int64 begin = WindowTimeNano();
+    HDC deviceContext = GetDC(native->windowHandle);
+    makeCurrent(window, deviceContext);
+    UpscalerPresent(window);
+    SwapBuffers(deviceContext);
+    ReleaseDC(native->windowHandle, deviceContext);
+    return WindowTimeNano() - begin;
+}
+
+void GraphicsPresent(Window *window) {
+    window->native->presented = true;
+    window->stats.swapTime = swapBuffers(window);
+}
+
+int64 GraphicsSwapBuffers(Window *window) {
+    return swapBuffers(window);
+}
+
+bool GraphicsReleaseContext(Window *window) {
+    (void)window;
+    return wglMakeCurrent(nil, nil);
+}
+
+#endif  // MINO_NO_GL
+
+struct FramebufferNative {
+    Window *window;
+    // `memoryContext` has `bitmap` selected into it so it can be copied to
+    // the window with `BitBlt`.
+    HDC memoryContext;
+    HBITMAP bitmap;
+    HGDIOBJ previousBitmap;
+};
+
+bool FramebufferInit(Framebuffer *framebuffer, Window *window) {
+    int width = window->width, height = window->height;
+    *framebuffer = (Framebuffer){
+        .width = width,
+        .height = height,
+        .stride = width,
+        .screenWidth = width,
+        .screenHeight = height,
+        .screenStride = width,
+        .scale = 1,
+    };
+
+    // A negative height makes the rows go from top to bottom. 32 bit rows are
+    // always aligned so there's no padding.
+    BITMAPINFO info = {
+        .bmiHeader = {
+            .biSize = sizeof(BITMAPINFOHEADER),
+            .biWidth = width,
+            .biHeight = -height,
+            .biPlanes = 1,
+            .biBitCount = 32,
+            .biCompression = BI_RGB,
+        },
+    };
+    void *pixels = nil;
+    HBITMAP bitmap = CreateDIBSection(nil, &info, DIB_RGB_COLORS, &pixels, nil, 0);
+    if (bitmap == nil) return false;
+
+    HDC memoryContext = CreateCompatibleDC(nil);
+    if (memoryContext == nil) {
+        DeleteObject(bitmap);
+        return false;
+    }
+
+    FramebufferNative *native = framebuffer->native = allocate(FramebufferNative);
+    native->window = window;
+    native->memoryContext = memoryContext;
+    native->bitmap = bitmap;
+    native->previousBitmap = SelectObject(memoryContext, bitmap);
+    framebuffer->pixels = framebuffer->screen = pixels;
+    DamageAdd(&framebuffer->damage, 0, 0, width, height);
+    return true;
+}
+
+void FramebufferPresent(Framebuffer *framebuffer) {
+    FramebufferNative *native = framebuffer->native;
+    HWND windowHandle = native->window->native->windowHandle;
+
+    Damage *damage = &framebuffer->damage;
+    if (damage->count == 0) return;
+
+    // GDI may batch drawing to the bitmap, which has to be finished first.
+    // The desktop compositor keeps a copy of the window, so unlike X11 it
+    // never needs to be redrawn in full after being uncovered.
+    GdiFlush();
+    HDC deviceContext = GetDC(windowHandle);
+    for (int i = 0; i < damage->count; i++) {
+        DamageRect rect = damage->rects[i];
+        FramebufferUpscale(framebuffer, rect);
+        BitBlt(
+            deviceContext,
+            rect.x, rect.y, rect.width, rect.height,
+            native->memoryContext,
+            rect.x, rect.y,
+            SRCCOPY);
+    }
+    ReleaseDC(windowHandle, deviceContext);
+    DamageClear(damage);
+}
+
+void FramebufferClose(Framebuffer *framebuffer) {
+    FramebufferNative *native = framebuffer->native;
+    if (native == nil) return;
+    if (framebuffer->pixels != framebuffer->screen) free(framebuffer->pixels);
+    SelectObject(native->memoryContext, native->previousBitmap);
+    DeleteDC(native->memoryContext);
+    DeleteObject(native->bitmap);
+    free(native);
+    *framebuffer = (Framebuffer){0};
+}
+
 #elif defined(PLATFORM_Linux)
 
 // Gotta clean this up so X11 can work. Now `MinoWindow` is the Window for Mino
@@ -486,31 +1016,108 @@ static Key XKey2MinoKey(int key) {
 }
 
 // `XKey2MinoKey` needs to be before `#include <linux/input.h>` because it contains defines that collide with Mino.
+#include <errno.h>
 #include <fcntl.h>
+#if !defined(MINO_NO_GL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <GL/gl.h>
 #include <GL/glx.h>
+#endif
 #include <libudev.h>
 #include <linux/input.h>
 #include <linux/types.h>
+#include <poll.h>
+#include <pthread.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <time.h>
 #include <unistd.h>
-#include <X11/XKBlib.h>
 #include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
 
 struct WindowNative {
     Display *xDisplay;
     Window xWindow;
     Atom deleteWindow;
     XVisualInfo *visualInfo;
+#if !defined(MINO_NO_GL)
+    GLXFBConfig fbConfig;
+#endif
+    // `graphics` is the context requested in `WindowConfig`, with anything
+    // the chosen framebuffer configuration can't do turned off.
+    GraphicsConfig graphics;
     struct udev *udev;
     struct udev_monitor *monitor;
-
+    // `epoll` watches the X connection, the udev monitor and every connected
+    // gamepad so `WindowWaitEvents` can sleep until any of them has input.
+    int epoll;
+    // `xTimeOffset` converts X server timestamps to `WindowTimeNano` time.
+    int64 xTimeOffset;
+    // `keyTable` maps X key codes directly to Mino key codes. It is rebuilt
+    // whenever the keyboard mapping changes.
+    Key keyTable[256];
+
+    // `inputWindow` is only set when input is handled on its own thread. The
+    // input thread owns it (and the gamepads in it) and publishes its state to
+    // `snapshot`. `inputSignal` is an eventfd the thread writes to whenever new
+    // input arrives.
+    MinoWindow *inputWindow;
+    pthread_t inputThread;
+    bool inputThreadStarted;
+    int64 inputPeriod;
+    bool inputThreadStop;
+    int inputSignal;
+    SnapshotLock snapshot;
+    float32 rumble[INPUT_SNAPSHOT_GAMEPADS][2];
+    int scrollX, scrollY;
+
+    int viewportWidth, viewportHeight;
+    // `exposed` is set when the X server has lost what was in the window and
+    // the next present has to redraw all of it.
+    bool exposed;
+
+#if !defined(MINO_NO_GL)
     GLXContext glContext;
+    // `copySubBuffer` copies part of the back buffer to the front buffer. It
+    // is nil if the driver doesn't have GLX_MESA_copy_sub_buffer.
+    PFNGLXCOPYSUBBUFFERMESAPROC copySubBuffer;
+#endif
+    // `damage` is what `GraphicsAddDamage` marked as changed this frame.
+    Damage damage;
+
+    // `headless` windows have no X window and no input devices. Input is
+    // played back from `script` and graphics are drawn offscreen with EGL.
+    bool headless;
+    const InputScript *script;
+    int scriptIndex;
+    int64 frame;
+#if !defined(MINO_NO_GL)
+    EGLDisplay eglDisplay;
+    EGLContext eglContext;
+    EGLSurface eglSurface;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swapBuffersWithDamage;
+#endif
+
+    // `swapInterval` is the last interval set with `GraphicsSetSwapInterval`.
+    int swapInterval;
+    // `presented` is set once the frame has been shown, so `WindowUpdate`
+    // knows whether it still has to.
+    bool presented;
+    // `threadSafe` is set if Xlib was told it would be used from multiple
+    // threads, so the context can be moved to a render thread.
+    bool threadSafe;
 };
 
 struct GamepadNative {
     int fileDescriptor;
+    // `monotonicTime` is set when the kernel was able to timestamp events with
+    // `CLOCK_MONOTONIC` instead of the wall clock.
+    bool monotonicTime;
     char *devicePath;
     struct input_absinfo analogInfos[GamepadAxis_Count];
     struct ff_effect rumble;
@@ -585,7 +1192,7 @@ static void connectController(MinoWindow *window, const char *devicePath) {
     // Finally, if no controllers are disconnected, just connect a
     // new controller.
     {
-        GamepadListPush(&window->gamepads, (Gamepad){});
+        GamepadListPush(&window->gamepads, (Gamepad){.playerID = window->gamepads.len});
         gamepad = GamepadListGet(&window->gamepads, window->gamepads.len - 1);
         gamepad->native = malloc(sizeof(GamepadNative));
         memset(gamepad->native, 0, sizeof(GamepadNative));
@@ -608,7 +1215,16 @@ foundGamepad:;
         };
     }
     gamepad->native->fileDescriptor = fd;
+    gamepad->native->monotonicTime = ioctl(fd, EVIOCSCLOCKID, &(int){CLOCK_MONOTONIC}) == 0;
     gamepad->connected = true;
+
+    epoll_ctl(window->native->epoll, EPOLL_CTL_ADD, fd, &(struct epoll_event){.events = EPOLLIN});
+
+    InputQueuePush(&window->events, (InputEvent){
+        .type = InputEventType_GamepadConnect,
+        .time = WindowTimeNano(),
+        .gamepad = {.playerID = gamepad->playerID},
+    });
 }
 
 static void disconnectController(MinoWindow *window, const char *devicePath) {
@@ -622,6 +1238,7 @@ static void disconnectController(MinoWindow *window, const char *devicePath) {
     }
     if (gamepad == nil) return;
 
+    epoll_ctl(window->native->epoll, EPOLL_CTL_DEL, gamepad->native->fileDescriptor, nil);
     close(gamepad->native->fileDescriptor);
     gamepad->native->fileDescriptor = 0;
     gamepad->connected = false;
@@ -631,23 +1248,136 @@ static void disconnectController(MinoWindow *window, const char *devicePath) {
     for (int i = 0; i < GamepadAxis_Count; i++) {
         gamepad->axes[i] = 0;
     }
+
+    InputQueuePush(&window->events, (InputEvent){
+        .type = InputEventType_GamepadDisconnect,
+        .time = WindowTimeNano(),
+        .gamepad = {.playerID = gamepad->playerID},
+    });
+}
+
+static void *inputThreadMain(void *data);
+
+// `buildKeyTable` looks up the symbol for every key code once so handling a
+// key event only needs to index `keyTable` instead of asking Xlib for the key
+// symbol and converting it.
+static void buildKeyTable(WindowNative *native) {
+    for (int i = 0; i < (int)len(native->keyTable, Key); i++) {
+        native->keyTable[i] = Key_Invalid;
+    }
+
+    int minKeycode, maxKeycode, symbolsPerKeycode;
+    XDisplayKeycodes(native->xDisplay, &minKeycode, &maxKeycode);
+    KeySym *symbols = XGetKeyboardMapping(
+        native->xDisplay,
+        minKeycode,
+        maxKeycode - minKeycode + 1,
+        &symbolsPerKeycode);
+    if (symbols == nil) return;
+
+    for (int keycode = minKeycode; keycode <= maxKeycode && keycode < (int)len(native->keyTable, Key); keycode++) {
+        // Only the first (unshifted) symbol is used, the same as looking up
+        // level 0 of group 0. Letters may be listed in upper case so convert
+        // them to lower case to match `XKey2MinoKey`.
+        KeySym lower, upper;
+        XConvertCase(symbols[(keycode - minKeycode) * symbolsPerKeycode], &lower, &upper);
+        native->keyTable[keycode] = XKey2MinoKey(lower);
+    }
+    XFree(symbols);
+}
+
+static bool initHeadless(MinoWindow *window, WindowConfig config) {
+    window->native = allocate(WindowNative);
+    *window->native = (WindowNative){
+        .epoll = -1,
+        .graphics = config.graphics,
+        .headless = true,
+        .script = config.inputScript,
+    };
+    window->width = config.width;
+    window->height = config.height;
+    GamepadListInit(&window->gamepads, 0, 4);
+    return true;
+}
+
+#if !defined(MINO_NO_GL)
+
+// `chooseFBConfig` picks the framebuffer configuration that best matches
+// `graphics`. If nothing supports multisampling or sRGB, those are turned off
+// in `graphics` and the search is tried again without them.
+static bool chooseFBConfig(Display *display, GraphicsConfig *graphics, GLXFBConfig *fbConfig) {
+    while (true) {
+        int attributes[32];
+        int count = 0;
+        int base[] = {
+            GLX_X_RENDERABLE, True,
+            GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
+            GLX_RENDER_TYPE, GLX_RGBA_BIT,
+            GLX_DOUBLEBUFFER, True,
+            GLX_RED_SIZE, 8,
+            GLX_GREEN_SIZE, 8,
+            GLX_BLUE_SIZE, 8,
+            GLX_DEPTH_SIZE, 24,
+        };
+        for (int i = 0; i < (int)len(base, int); i++) attributes[count++] = base[i];
+        if (graphics->samples > 0) {
+            attributes[count++] = GLX_SAMPLE_BUFFERS;
+            attributes[count++] = 1;
+            attributes[count++] = GLX_SAMPLES;
+            attributes[count++] = graphics->samples;
+        }
+        if (graphics->srgb) {
+            attributes[count++] = GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB;
+            attributes[count++] = True;
+        }
+        attributes[count++] = None;
+
+        int configCount = 0;
+        GLXFBConfig *configs = glXChooseFBConfig(display, DefaultScreen(display), attributes, &configCount);
+        if (configs != nil && configCount > 0) {
+            *fbConfig = configs[0];
+            XFree(configs);
+            return true;
+        }
+        if (configs != nil) XFree(configs);
+
+        if (graphics->samples > 0) {
+            graphics->samples = 0;
+        } else if (graphics->srgb) {
+            graphics->srgb = false;
+        } else {
+            return false;
+        }
+    }
 }
 
+#endif  // MINO_NO_GL
+
 bool WindowInit(MinoWindow *window, WindowConfig config) {
+    if (config.headless) return initHeadless(window, config);
+
+    // Xlib needs to be told it will be used from multiple threads before it
+    // is used for anything else.
+    if (config.inputRate > 0 || config.renderThread) XInitThreads();
+
     Display *xDisplay = XOpenDisplay(nil);
     if (xDisplay == nil) return false;
 
-    XVisualInfo *visualInfo = glXChooseVisual(
-        xDisplay,
-        0,
-        (GLint[]){
-            GLX_RGBA,
-            GLX_DEPTH_SIZE,
-            24,
-            GLX_DOUBLEBUFFER,
-            None,
-        });
+    GraphicsConfig graphics = config.graphics;
+#if defined(MINO_NO_GL)
+    // Without OpenGL the window only needs the default visual, which is what
+    // `Framebuffer` images are made in.
+    XVisualInfo visualTemplate = {
+        .visualid = XVisualIDFromVisual(DefaultVisual(xDisplay, DefaultScreen(xDisplay))),
+    };
+    int visualCount = 0;
+    XVisualInfo *visualInfo = XGetVisualInfo(xDisplay, VisualIDMask, &visualTemplate, &visualCount);
+#else
+    GLXFBConfig fbConfig;
+    if (chooseFBConfig(xDisplay, &graphics, &fbConfig) == false) return false;
 
+    XVisualInfo *visualInfo = glXGetVisualFromFBConfig(xDisplay, fbConfig);
+#endif
     if (visualInfo == nil) return false;
 
     Window root = DefaultRootWindow(xDisplay);
@@ -676,6 +1406,8 @@ bool WindowInit(MinoWindow *window, WindowConfig config) {
         &windowAttributes);
 
     if (xWindow == 0) return false;
+    window->width = config.width;
+    window->height = config.height;
 
     Atom deleteWindowAtom = XInternAtom(xDisplay, "WM_DELETE_WINDOW", false);
     XSetWMProtocols(xDisplay, xWindow, &deleteWindowAtom, 1);
@@ -692,16 +1424,43 @@ bool WindowInit(MinoWindow *window, WindowConfig config) {
         return false;
     }
 
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll < 0) {
+        println("Warning: unable to create epoll instance");
+        udev_unref(udev);
+        XDestroyWindow(xDisplay, xWindow);
+        return false;
+    }
+    epoll_ctl(epoll, EPOLL_CTL_ADD, ConnectionNumber(xDisplay), &(struct epoll_event){.events = EPOLLIN});
+
     window->native = allocate(WindowNative);
     *window->native = (WindowNative){
         .xDisplay = xDisplay,
         .xWindow = xWindow,
         .deleteWindow = deleteWindowAtom,
         .visualInfo = visualInfo,
+#if !defined(MINO_NO_GL)
+        .fbConfig = fbConfig,
+#endif
+        .graphics = graphics,
         .udev = udev,
+        .epoll = epoll,
+        .threadSafe = config.inputRate > 0 || config.renderThread,
     };
+    buildKeyTable(window->native);
     GamepadListInit(&window->gamepads, 0, 4);
 
+    // When input is handled on its own thread, devices are opened into the
+    // input thread's window instead.
+    MinoWindow *input = window;
+    if (config.inputRate > 0) {
+        input = window->native->inputWindow = allocate(MinoWindow);
+        input->native = window->native;
+        input->width = window->width;
+        input->height = window->height;
+        GamepadListInit(&input->gamepads, 0, 4);
+    }
+
     struct udev_enumerate *devices = udev_enumerate_new(udev);
     udev_enumerate_add_match_subsystem(devices, "input");
     udev_enumerate_add_match_property(devices, "ID_INPUT_JOYSTICK", "1");
@@ -715,7 +1474,7 @@ bool WindowInit(MinoWindow *window, WindowConfig config) {
         const char *devicePath = udev_device_get_devnode(device);
         if (hasPrefix(devicePath, "/dev/input/event") == false) goto end;
 
-        connectController(window, devicePath);
+        connectController(input, devicePath);
     end:
         udev_device_unref(device);
     }
@@ -725,32 +1484,57 @@ bool WindowInit(MinoWindow *window, WindowConfig config) {
     udev_monitor_filter_add_match_subsystem_devtype(monitor, "input", nil);
     udev_monitor_enable_receiving(monitor);
     window->native->monitor = monitor;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, udev_monitor_get_fd(monitor), &(struct epoll_event){.events = EPOLLIN});
+
+    if (input != window) {
+        WindowNative *native = window->native;
+        native->inputPeriod = 1000000000 / config.inputRate;
+        native->inputSignal = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        InputSnapshot snapshot;
+        InputSnapshotCapture(input, &snapshot);
+        SnapshotPublish(&native->snapshot, &snapshot);
+
+        if (native->inputSignal < 0 || pthread_create(&native->inputThread, nil, inputThreadMain, native) != 0) {
+            println("Warning: unable to start the input thread");
+            WindowClose(window);
+            return false;
+        }
+        native->inputThreadStarted = true;
+    }
 
     return true;
 }
 
+// `maxHotplugEvents` limits how many udev events are handled in a single
+// frame. Anything left over stays queued on the monitor and is handled during
+// the next frame so plugging in a hub full of devices can't stall a frame.
+static const int maxHotplugEvents = 16;
+
 static void refreshControllers(MinoWindow *window) {
-    fd_set fileDescriptors;
-    FD_ZERO(&fileDescriptors);
-    FD_SET(udev_monitor_get_fd(window->native->monitor), &fileDescriptors);
-    while (true) {
-        if (FD_ISSET(udev_monitor_get_fd(window->native->monitor), &fileDescriptors)) {
-            struct udev_device *device;
-            const char *action;
-            device = udev_monitor_receive_device(window->native->monitor);
-            if (device == nil) {
-                return;
-            }
+    int64 begin = WindowTimeNano();
+    int events = 0;
+
+    // Check if udev has anything for us without blocking. This is usually the
+    // only work done here since devices are rarely plugged in or removed.
+    struct pollfd monitor = {
+        .fd = udev_monitor_get_fd(window->native->monitor),
+        .events = POLLIN,
+    };
+    if (poll(&monitor, 1, 0) > 0 && (monitor.revents & POLLIN)) {
+        while (events < maxHotplugEvents) {
+            struct udev_device *device = udev_monitor_receive_device(window->native->monitor);
+            if (device == nil) break;
+            events++;
 
             const char *isJoystick = udev_device_get_property_value(device, "ID_INPUT_JOYSTICK");
             if (isJoystick == nil || strcmp(isJoystick, "1") != 0) goto end;
 
             const char *devicePath = udev_device_get_devnode(device);
-            if (hasPrefix(devicePath, "/dev/input/event") == false) {
-                goto end;
-            }
+            if (hasPrefix(devicePath, "/dev/input/event") == false) goto end;
 
-            action = udev_device_get_action(device);
+            const char *action = udev_device_get_action(device);
+            if (action == nil) goto end;
             if (strcmp(action, "add") == 0) {
                 connectController(window, devicePath);
             } else if (strcmp(action, "remove") == 0) {
@@ -760,6 +1544,9 @@ static void refreshControllers(MinoWindow *window) {
             udev_device_unref(device);
         }
     }
+
+    window->stats.hotplugEvents = events;
+    window->stats.hotplugTime = WindowTimeNano() - begin;
 }
 
 static void setAxis(Gamepad *gamepad, struct input_event event) {
@@ -853,7 +1640,11 @@ static void updateControllers(MinoWindow *window) {
         while (true) {
             int32 bytesRead = read(gamepad->native->fileDescriptor, &events, sizeof(events));
             if (bytesRead == -1) break;
-            for (int32 i = 0; (i + 1) * (int32)sizeof(struct input_event) < bytesRead; i++) {
+            for (int32 i = 0; (i + 1) * (int32)sizeof(struct input_event) <= bytesRead; i++) {
+                uint32 buttons = gamepad->buttons;
+                float32 axes[GamepadAxis_Count];
+                copy(gamepad->axes, axes, sizeof(axes));
+
                 switch (events[i].type) {
                     case EV_ABS: {
                         setAxis(gamepad, events[i]);
@@ -861,7 +1652,14 @@ static void updateControllers(MinoWindow *window) {
                     case EV_KEY: {
                         setButton(gamepad, events[i]);
                     } break;
+                    default: continue;
                 }
+
+                int64 time = WindowTimeNano();
+                if (gamepad->native->monotonicTime) {
+                    time = (int64)events[i].input_event_sec * 1000000000 + (int64)events[i].input_event_usec * 1000;
+                }
+                pushGamepadChanges(window, gamepad, buttons, axes, time);
             }
         }
         if (gamepad->leftMotor != gamepad->pLeftMotor || gamepad->rightMotor != gamepad->pRightMotor) {
@@ -872,176 +1670,511 @@ static void updateControllers(MinoWindow *window) {
     }
 }
 
-bool WindowUpdate(MinoWindow *window) {
-    XEvent event;
+// `XButton2MinoButton` converts an X pointer button into a `MouseButton`.
+// Buttons 4 through 7 are the scroll wheel and return -1.
+static int XButton2MinoButton(int button) {
+    switch (button) {
+        case 1: return MouseButton_Left;
+        case 2: return MouseButton_Middle;
+        case 3: return MouseButton_Right;
+        case 8: return MouseButton_Back;
+        case 9: return MouseButton_Forward;
+        default: return -1;
+    }
+}
+
+// `processXEvent` updates the input state of `window` with a single X event.
+// This returns false if the user asked to close the window.
+static bool processXEvent(MinoWindow *window, XEvent *event) {
     WindowNative *native = window->native;
+    switch (event->type) {
+        case Expose: {
+            XWindowAttributes windowAttributes;
+            XGetWindowAttributes(
+                native->xDisplay,
+                native->xWindow,
+                &windowAttributes);
+
+            window->width = windowAttributes.width;
+            window->height = windowAttributes.height;
+            __atomic_store_n(&native->exposed, true, __ATOMIC_RELAXED);
+        } break;
 
-    resetInputState(window);
-    refreshControllers(window);
-    updateControllers(window);
-    if (window->native->glContext) {
-        glXMakeCurrent(
-            window->native->xDisplay,
-            window->native->xWindow,
-            window->native->glContext);
-        glXSwapBuffers(
-            window->native->xDisplay,
-            window->native->xWindow);
-    }
-    while (XPending(native->xDisplay)) {
-        XNextEvent(native->xDisplay, &event);
-        switch (event.type) {
-            case Expose: {
-                XWindowAttributes windowAttributes;
-                XGetWindowAttributes(
-                    window->native->xDisplay,
-                    window->native->xWindow,
-                    &windowAttributes);
-
-                window->width = windowAttributes.width;
-                window->height = windowAttributes.height;
-
-                if (window->native->glContext) {
-                    glViewport(
-                        0, 0,
-                        windowAttributes.width,
-                        windowAttributes.height);
-                }
-            } break;
-
-            case MotionNotify: {
-                window->mouseX = event.xmotion.x;
-                window->mouseY = event.xmotion.y;
-            } break;
-
-            case ButtonPress: {
-                switch (event.xbutton.button) {
-                    case 1:
-                        window->mousePressed = setBit(window->mousePressed, MouseButton_Left);
-                        break;
-                    case 2:
-                        window->mousePressed = setBit(window->mousePressed, MouseButton_Middle);
-                        break;
-                    case 3:
-                        window->mousePressed = setBit(window->mousePressed, MouseButton_Right);
-                        break;
-                    case 4:
-                        window->scrollY++;
-                        break;
-                    case 5:
-                        window->scrollY--;
-                        break;
-                    case 6:
-                        window->scrollX--;
-                        break;
-                    case 7:
-                        window->scrollX++;
-                        break;
-                    case 8:
-                        window->mousePressed = setBit(window->mousePressed, MouseButton_Back);
-                        break;
-                    case 9:
-                        window->mousePressed = setBit(window->mousePressed, MouseButton_Forward);
-                        break;
+        case MotionNotify: {
+            window->mouseX = event->xmotion.x;
+            window->mouseY = event->xmotion.y;
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_MouseMove,
+                .time = InputTimeFromMillis(&native->xTimeOffset, event->xmotion.time),
+                .mouse = {.x = event->xmotion.x, .y = event->xmotion.y},
+            });
+        } break;
+
+        case ButtonPress:
+        case ButtonRelease: {
+            bool pressed = event->type == ButtonPress;
+            int64 time = InputTimeFromMillis(&native->xTimeOffset, event->xbutton.time);
+            int button = XButton2MinoButton(event->xbutton.button);
+            if (button >= 0) {
+                if (pressed) {
+                    window->mousePressed = setBit(window->mousePressed, button);
+                } else {
+                    window->mousePressed = unsetBit(window->mousePressed, button);
                 }
+                InputQueuePush(&window->events, (InputEvent){
+                    .type = pressed ? InputEventType_MousePress : InputEventType_MouseRelease,
+                    .time = time,
+                    .mouse = {.button = button, .x = event->xbutton.x, .y = event->xbutton.y},
+                });
                 break;
             }
 
-            case ButtonRelease: {
-                switch (event.xbutton.button) {
-                    case 1:
-                        window->mousePressed = unsetBit(window->mousePressed, MouseButton_Left);
-                        break;
-                    case 2:
-                        window->mousePressed = unsetBit(window->mousePressed, MouseButton_Middle);
-                        break;
-                    case 3:
-                        window->mousePressed = unsetBit(window->mousePressed, MouseButton_Right);
-                        break;
-                    case 8:
-                        window->mousePressed = unsetBit(window->mousePressed, MouseButton_Back);
-                        break;
-                    case 9:
-                        window->mousePressed = unsetBit(window->mousePressed, MouseButton_Forward);
-                        break;
-                }
-            } break;
-
-            case KeyPress:
-            case KeyRelease: {
-                KeySym keySymbol = XkbKeycodeToKeysym(native->xDisplay, event.xkey.keycode, 0, 0);
-                Key key = XKey2MinoKey(keySymbol);
-                if (key == Key_Invalid) break;
-
-                window->keyPressed[key] = event.type == KeyPress;
-
-                if (key == Key_LeftCtrl || key == Key_RightCtrl)
-                    window->keyPressed[Key_Ctrl] = (window->keyPressed[Key_LeftCtrl] || window->keyPressed[Key_RightCtrl]);
-                else if (key == Key_LeftShift || key == Key_RightShift)
-                    window->keyPressed[Key_Shift] = (window->keyPressed[Key_LeftShift] || window->keyPressed[Key_RightShift]);
-                else if (key == Key_LeftWin || key == Key_RightWin)
-                    window->keyPressed[Key_Win] = (window->keyPressed[Key_LeftWin] || window->keyPressed[Key_RightWin]);
-                else if (key == Key_LeftAlt || key == Key_RightAlt)
-                    window->keyPressed[Key_Alt] = (window->keyPressed[Key_LeftAlt] || window->keyPressed[Key_RightAlt]);
-
-                window->KeyMod =
-                    (window->keyPressed[Key_Win] ? KeyMod_Win : 0) |
-                    (window->keyPressed[Key_Alt] ? KeyMod_Alt : 0) |
-                    (window->keyPressed[Key_Shift] ? KeyMod_Shift : 0) |
-                    (window->keyPressed[Key_Ctrl] ? KeyMod_Ctrl : 0) |
-                    (bitSet(event.xkey.state, LockMapIndex) ? KeyMod_CapsLock : 0) |
-                    (bitSet(event.xkey.state, Mod2MapIndex) ? KeyMod_NumLock : 0) |
-                    (bitSet(event.xkey.state, Mod5MapIndex) ? KeyMod_ScrollLock : 0);
-
-                if (event.type == KeyPress) {
-                    char buffer[sizeof(rune)];
-                    if (XLookupString(&event.xkey, buffer, sizeof(buffer), &keySymbol, NULL) > 0) {
-                        mbstowcs(&window->keyChar, buffer, 1);
-                    };
-                }
-            } break;
+            // The scroll wheel sends a press and release for each step. We
+            // only need to count one of them.
+            if (pressed == false) break;
+            int scrollX = 0, scrollY = 0;
+            switch (event->xbutton.button) {
+                case 4: scrollY = 1; break;
+                case 5: scrollY = -1; break;
+                case 6: scrollX = -1; break;
+                case 7: scrollX = 1; break;
+            }
+            window->scrollX += scrollX;
+            window->scrollY += scrollY;
+            InputQueuePush(&window->events, (InputEvent){
+                .type = InputEventType_Scroll,
+                .time = time,
+                .scroll = {.x = scrollX, .y = scrollY},
+            });
+        } break;
 
-            case ClientMessage: {
-                if (event.xclient.data.l[0] == (long)native->deleteWindow) {
-                    return false;
-                }
-            } break;
+        case KeyPress:
+        case KeyRelease: {
+            Key key = native->keyTable[event->xkey.keycode & 0xFF];
+            if (key == Key_Invalid) break;
+
+            KeySetPut(&window->keyPressed, key, event->type == KeyPress);
+            int64 time = InputTimeFromMillis(&native->xTimeOffset, event->xkey.time);
+            InputQueuePush(&window->events, (InputEvent){
+                .type = event->type == KeyPress ? InputEventType_KeyPress : InputEventType_KeyRelease,
+                .time = time,
+                .key = key,
+            });
+
+            KeySet *keys = &window->keyPressed;
+            KeySetUpdateModifiers(keys, key);
+
+            window->KeyMod =
+                (KeySetHas(*keys, Key_Win) ? KeyMod_Win : 0) |
+                (KeySetHas(*keys, Key_Alt) ? KeyMod_Alt : 0) |
+                (KeySetHas(*keys, Key_Shift) ? KeyMod_Shift : 0) |
+                (KeySetHas(*keys, Key_Ctrl) ? KeyMod_Ctrl : 0) |
+                (bitSet(event->xkey.state, LockMapIndex) ? KeyMod_CapsLock : 0) |
+                (bitSet(event->xkey.state, Mod2MapIndex) ? KeyMod_NumLock : 0) |
+                (bitSet(event->xkey.state, Mod5MapIndex) ? KeyMod_ScrollLock : 0);
+
+            if (event->type == KeyPress) {
+                KeySym keySymbol;
+                char buffer[sizeof(rune)];
+                if (XLookupString(&event->xkey, buffer, sizeof(buffer), &keySymbol, NULL) > 0) {
+                    mbstowcs(&window->keyChar, buffer, 1);
+                    InputQueuePush(&window->events, (InputEvent){
+                        .type = InputEventType_Char,
+                        .time = time,
+                        .character = window->keyChar,
+                    });
+                };
+            }
+        } break;
+
+        case MappingNotify: {
+            XRefreshKeyboardMapping(&event->xmapping);
+            if (event->xmapping.request == MappingKeyboard) {
+                buildKeyTable(native);
+            }
+        } break;
+
+        case ClientMessage: {
+            if (event->xclient.data.l[0] == (long)native->deleteWindow) {
+                return false;
+            }
+        } break;
+    }
+    return true;
+}
+
+// `pumpXEvents` processes every event waiting on the X connection. This returns
+// false if the user asked to close the window.
+static bool pumpXEvents(MinoWindow *window) {
+    XEvent event;
+    while (XPending(window->native->xDisplay)) {
+        XNextEvent(window->native->xDisplay, &event);
+        if (processXEvent(window, &event) == false) return false;
+    }
+    return true;
+}
+
+// `discardXEvents` empties the X event queue without touching the input state
+// of `window`, for when input is being replayed from a recording. This returns
+// false if the user asked to close the window.
+static bool discardXEvents(MinoWindow *window) {
+    XEvent event;
+    while (XPending(window->native->xDisplay)) {
+        XNextEvent(window->native->xDisplay, &event);
+        if (event.type == ClientMessage && event.xclient.data.l[0] == (long)window->native->deleteWindow) {
+            return false;
         }
     }
     return true;
 }
 
-void WindowClose(MinoWindow *window) {
-    XFree(window->native->visualInfo);
-    XDestroyWindow(window->native->xDisplay, window->native->xWindow);
-    XCloseDisplay(window->native->xDisplay);
+static void updateViewport(MinoWindow *window) {
+#if !defined(MINO_NO_GL)
+    WindowNative *native = window->native;
+    if (native->glContext == nil || window->upscaler || window->renderThread) return;
+    if (window->width == native->viewportWidth && window->height == native->viewportHeight) return;
+    native->viewportWidth = window->width;
+    native->viewportHeight = window->height;
+    glViewport(0, 0, window->width, window->height);
+#else
+    (void)window;
+#endif
+}
+
+#if !defined(MINO_NO_GL)
+
+// `makeCurrent` binds the window's context unless it already is. Asking what
+// is current doesn't have to talk to the X server or the driver, unlike
+// binding, so this saves a round trip on every frame.
+static void makeCurrent(MinoWindow *window) {
+    WindowNative *native = window->native;
+    if (native->headless) {
+        if (eglGetCurrentContext() == native->eglContext &&
+            eglGetCurrentSurface(EGL_DRAW) == native->eglSurface) {
+            return;
+        }
+        eglMakeCurrent(native->eglDisplay, native->eglSurface, native->eglSurface, native->eglContext);
+        return;
+    }
+    if (glXGetCurrentContext() == native->glContext && glXGetCurrentDrawable() == native->xWindow) return;
+    glXMakeCurrent(native->xDisplay, native->xWindow, native->glContext);
+}
+
+// `swapBuffersHeadless` shows the frame drawn to the offscreen EGL surface,
+// passing along the damage so the driver can skip the rest.
+static void swapBuffersHeadless(MinoWindow *window) {
+    WindowNative *native = window->native;
+    if (native->eglContext == nil) return;
+    makeCurrent(window);
+    UpscalerPresent(window);
+    bool partial = native->damage.count > 0 && window->upscaler == nil;
+    if (partial && native->swapBuffersWithDamage) {
+        EGLint rects[DAMAGE_MAX_RECTS * 4];
+        for (int i = 0; i < native->damage.count; i++) {
+            DamageRect rect = native->damage.rects[i];
+            rects[i * 4 + 0] = rect.x;
+            rects[i * 4 + 1] = window->height - rect.y - rect.height;
+            rects[i * 4 + 2] = rect.width;
+            rects[i * 4 + 3] = rect.height;
+        }
+        native->swapBuffersWithDamage(native->eglDisplay, native->eglSurface, rects, native->damage.count);
+    } else {
+        eglSwapBuffers(native->eglDisplay, native->eglSurface);
+    }
+}
+
+#endif  // MINO_NO_GL
+
+// `swapBuffers` shows the frame drawn with OpenGL. If parts of the window
+// were marked with `GraphicsAddDamage`, only those are copied to the front
+// buffer, unless the X server lost the window's contents and it all has to be
+// shown again.
+static int64 swapBuffers(MinoWindow *window) {
+    WindowNative *native = window->native;
+    int64 begin = WindowTimeNano();
+#if !defined(MINO_NO_GL)
+    if (native->headless) {
+        swapBuffersHeadless(window);
+    } else if (native->glContext) {
+        makeCurrent(window);
+        UpscalerPresent(window);
+        // The upscaled image always covers the whole window so damage is
+        // only used when drawing to the window directly.
+        bool exposed = __atomic_exchange_n(&native->exposed, false, __ATOMIC_RELAXED);
+        bool partial = native->damage.count > 0 && window->upscaler == nil && exposed == false;
+        if (partial && native->copySubBuffer) {
+            // OpenGL puts the origin in the bottom left corner.
+            for (int i = 0; i < native->damage.count; i++) {
+                DamageRect rect = native->damage.rects[i];
+                native->copySubBuffer(
+                    native->xDisplay,
+                    native->xWindow,
+                    rect.x, window->height - rect.y - rect.height,
+                    rect.width, rect.height);
+            }
+        } else {
+            glXSwapBuffers(native->xDisplay, native->xWindow);
+        }
+    }
+#endif
+    DamageClear(&native->damage);
+    return WindowTimeNano() - begin;
+}
+
+// `inputThreadMain` runs on its own thread when the window was created with an
+// `inputRate`. It handles input into `native->inputWindow` at a fixed rate and
+// publishes a snapshot after each pass so the game thread can pick up the
+// newest state whenever it likes.
+static void *inputThreadMain(void *data) {
+    WindowNative *native = data;
+    MinoWindow *input = native->inputWindow;
+    InputSnapshot snapshot;
+    bool open = true;
+
+    int64 deadline = WindowTimeNano();
+    while (__atomic_load_n(&native->inputThreadStop, __ATOMIC_ACQUIRE) == false) {
+        uint32 tail = input->events.tail;
+
+        for (int i = 0; i < input->gamepads.len && i < INPUT_SNAPSHOT_GAMEPADS; i++) {
+            Gamepad *gamepad = GamepadListGet(&input->gamepads, i);
+            __atomic_load(&native->rumble[i][0], &gamepad->leftMotor, __ATOMIC_RELAXED);
+            __atomic_load(&native->rumble[i][1], &gamepad->rightMotor, __ATOMIC_RELAXED);
+        }
+
+        refreshControllers(input);
+        updateControllers(input);
+        if (open) open = pumpXEvents(input);
+
+        InputSnapshotCapture(input, &snapshot);
+        snapshot.closed = open == false;
+        SnapshotPublish(&native->snapshot, &snapshot);
+
+        // Wake up `WindowWaitEvents` if anything happened.
+        if (input->events.tail != tail || open == false) {
+            // The eventfd doesn't block, so this fails with `EAGAIN` when its
+            // counter is full, but then it's already readable.
+            if (write(native->inputSignal, &(uint64){1}, sizeof(uint64)) < 0 && errno != EAGAIN) {
+                println("Warning: unable to signal new input");
+            }
+        }
+
+        deadline += native->inputPeriod;
+        int64 now = WindowTimeNano();
+        if (deadline < now) deadline = now;
+        WindowSleepUntil(deadline);
+    }
+    return nil;
+}
+
+// `updateFromInputThread` copies the latest state published by the input
+// thread into `window`. This returns false if the user asked to close the
+// window.
+static bool updateFromInputThread(MinoWindow *window) {
+    WindowNative *native = window->native;
+    InputSnapshot snapshot;
+    SnapshotRead(&native->snapshot, &snapshot);
+
+    InputEvent event;
+    while (InputQueuePop(&native->inputWindow->events, &event)) {
+        InputQueuePush(&window->events, event);
+        if (event.type == InputEventType_Char) window->keyChar = event.character;
+    }
+
+    window->keyPressed = snapshot.keyPressed;
+    window->KeyMod = snapshot.keyMod;
+    window->mouseX = snapshot.mouseX;
+    window->mouseY = snapshot.mouseY;
+    window->mousePressed = snapshot.mousePressed;
+    window->scrollX = snapshot.scrollX - native->scrollX;
+    window->scrollY = snapshot.scrollY - native->scrollY;
+    native->scrollX = snapshot.scrollX;
+    native->scrollY = snapshot.scrollY;
+    window->width = snapshot.width;
+    window->height = snapshot.height;
+
+    while (window->gamepads.len < snapshot.gamepadCount) {
+        GamepadListPush(&window->gamepads, (Gamepad){.playerID = window->gamepads.len});
+    }
+    for (int i = 0; i < snapshot.gamepadCount; i++) {
+        Gamepad *gamepad = GamepadListGet(&window->gamepads, i);
+        gamepad->connected = snapshot.gamepads[i].connected;
+        gamepad->buttons = snapshot.gamepads[i].buttons;
+        copy(snapshot.gamepads[i].axes, gamepad->axes, sizeof(gamepad->axes));
+        __atomic_store(&native->rumble[i][0], &gamepad->leftMotor, __ATOMIC_RELAXED);
+        __atomic_store(&native->rumble[i][1], &gamepad->rightMotor, __ATOMIC_RELAXED);
+    }
+
+    return snapshot.closed == false;
+}
+
+// `discardThreadInput` throws away what the input thread queued for `window`,
+// for when input is being replayed from a recording. It still follows the
+// scroll totals so the first live frame doesn't get all the scrolling done
+// during the replay, and the window size, which the replay overrides for as
+// long as it has frames left. This returns false if the user asked to close
+// the window.
+static bool discardThreadInput(MinoWindow *window) {
+    WindowNative *native = window->native;
+    InputSnapshot snapshot;
+    SnapshotRead(&native->snapshot, &snapshot);
+    InputQueueClear(&native->inputWindow->events);
+
+    native->scrollX = snapshot.scrollX;
+    native->scrollY = snapshot.scrollY;
+    window->width = snapshot.width;
+    window->height = snapshot.height;
+    return snapshot.closed == false;
+}
+
+bool WindowUpdate(MinoWindow *window) {
+    WindowNative *native = window->native;
+    resetInputState(window);
+    bool replaying = InputRecordingReplaying(window);
+    window->stats.eventTime = window->stats.controllerTime = 0;
+
+    // Show the frame first unless the game already did with
+    // `GraphicsPresent`. Either way input is read after the swap, which may
+    // have waited for vsync, so it's as fresh as possible for the next frame.
+    if (window->renderThread) {
+        window->stats.swapTime = 0;
+    } else if (native->presented == false) {
+        window->stats.swapTime = swapBuffers(window);
+    }
+    native->presented = false;
+
+    int64 begin = WindowTimeNano();
+    if (native->headless) {
+        if (replaying == false) {
+            InputScriptPlay(window, native->script, &native->scriptIndex, native->frame);
+        }
+        native->frame++;
+        window->stats.eventTime = WindowTimeNano() - begin;
+        InputRecordingUpdate(window);
+        return true;
+    }
+
+    bool open;
+    if (native->inputWindow) {
+        if (replaying) {
+            open = discardThreadInput(window);
+        } else {
+            open = updateFromInputThread(window);
+        }
+        window->stats.eventTime = WindowTimeNano() - begin;
+    } else if (replaying) {
+        open = discardXEvents(window);
+        window->stats.eventTime = WindowTimeNano() - begin;
+    } else {
+        refreshControllers(window);
+        updateControllers(window);
+        window->stats.controllerTime = WindowTimeNano() - begin;
+        begin = WindowTimeNano();
+        open = pumpXEvents(window);
+        window->stats.eventTime = WindowTimeNano() - begin;
+    }
+    InputRecordingUpdate(window);
+    updateViewport(window);
+    return open;
+}
+
+bool WindowWaitEvents(MinoWindow *window, int64 timeout) {
+    WindowNative *native = window->native;
+    // Scripted input is always ready so there's nothing to wait for.
+    if (native->headless) return WindowUpdate(window);
+
+    int milliseconds = -1;
+    if (timeout >= 0) milliseconds = (int)((timeout + 999999) / 1000000);
+
+    if (native->inputWindow) {
+        // The input thread owns the devices so wait for it to tell us
+        // something happened instead.
+        struct pollfd signal = {.fd = native->inputSignal, .events = POLLIN};
+        if (poll(&signal, 1, milliseconds) > 0) {
+            uint64 count;
+            // Reading resets the counter. `EAGAIN` just means it already was.
+            if (read(native->inputSignal, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                println("Warning: unable to read the input signal");
+            }
+        }
+        return WindowUpdate(window);
+    }
+
+    // Xlib may have already read events off the connection into its own
+    // queue. Those won't wake up epoll so only sleep if that queue is empty.
+    if (XPending(native->xDisplay) == 0) {
+        struct epoll_event events[8];
+        epoll_wait(native->epoll, events, len(events, struct epoll_event), milliseconds);
+    }
+    return WindowUpdate(window);
+}
+
+void WindowLatestInput(MinoWindow *window, InputSnapshot *snapshot) {
+    if (window->native->inputWindow) {
+        SnapshotRead(&window->native->snapshot, snapshot);
+        // The snapshot counts scrolling since the window was created but we
+        // want it since the last frame to match `Window`.
+        snapshot->scrollX -= window->native->scrollX;
+        snapshot->scrollY -= window->native->scrollY;
+        return;
+    }
+    InputSnapshotCapture(window, snapshot);
+}
+
+static void closeGamepads(GamepadList *gamepads) {
     Gamepad *gamepad;
-    for (int i = 0; i < window->gamepads.len; i++) {
-        gamepad = GamepadListGet(&window->gamepads, i);
+    for (int i = 0; i < gamepads->len; i++) {
+        gamepad = GamepadListGet(gamepads, i);
+        if (gamepad->native == nil) continue;
         if (gamepad->connected) {
             close(gamepad->native->fileDescriptor);
         }
-        if (gamepad->native != nil) {
-            if (gamepad->native->devicePath != nil) {
-                free(gamepad->native->devicePath);
-                gamepad->native->devicePath = nil;
-            }
-            free(gamepad->native);
-            gamepad->native = nil;
+        if (gamepad->native->devicePath != nil) {
+            free(gamepad->native->devicePath);
+            gamepad->native->devicePath = nil;
         }
+        free(gamepad->native);
+        gamepad->native = nil;
     }
-    GamepadListFree(&window->gamepads);
-    udev_monitor_unref(window->native->monitor);
-    udev_unref(window->native->udev);
-    free(window->native);
+    GamepadListFree(gamepads);
 }
 
-#include <time.h>
+void WindowClose(MinoWindow *window) {
+    WindowNative *native = window->native;
+    WindowStopRecording(window);
+    if (native->headless) {
+        closeGamepads(&window->gamepads);
+        free(native);
+        window->native = nil;
+        return;
+    }
+    if (native->inputWindow) {
+        if (native->inputThreadStarted) {
+            __atomic_store_n(&native->inputThreadStop, true, __ATOMIC_RELEASE);
+            pthread_join(native->inputThread, nil);
+        }
+        if (native->inputSignal >= 0) close(native->inputSignal);
+        closeGamepads(&native->inputWindow->gamepads);
+        free(native->inputWindow);
+    }
+    XFree(native->visualInfo);
+    XDestroyWindow(native->xDisplay, native->xWindow);
+    XCloseDisplay(native->xDisplay);
+    closeGamepads(&window->gamepads);
+    udev_monitor_unref(native->monitor);
+    udev_unref(native->udev);
+    close(native->epoll);
+    free(native);
+    window->native = nil;
+}
 
 int64 WindowTime() {
+    return WindowTimeNano() / 1000000;
+}
+
+int64 WindowTimeNano() {
     struct timespec time;
-    clock_gettime(CLOCK_REALTIME, &time);
-    return time.tv_sec * 1000 + (time.tv_nsec / 1000000);
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64)time.tv_sec * 1000000000 + time.tv_nsec;
 }
 
 void WindowSleep(int64 milliseconds) {
@@ -1051,36 +2184,321 @@ void WindowSleep(int64 milliseconds) {
     nanosleep(&time, nil);
 }
 
+void WindowSleepUntil(int64 deadline) {
+    struct timespec time = {
+        .tv_sec = deadline / 1000000000,
+        .tv_nsec = deadline % 1000000000,
+    };
+    // `clock_nanosleep` returns early when interrupted by a signal. Since the
+    // deadline is absolute we can simply try again.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nil) == EINTR) {
+    }
+}
+
+#if !defined(MINO_NO_GL)
+
+// `graphicsInitHeadless` creates an offscreen OpenGL context with EGL.
+//
+// Mesa's surfaceless platform is preferred since it doesn't need a display
+// server (or even a GPU, since it falls back to software rendering). A pbuffer
+// the size of the window is used as the default framebuffer. If pbuffers
+// aren't available, the context is made current without any surface and the
+// game will have to render into its own framebuffer objects.
+static bool graphicsInitHeadless(MinoWindow *window) {
+    WindowNative *native = window->native;
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (eglGetPlatformDisplayEXT && extensionSupported(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nil);
+    }
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY) return false;
+
+    if (eglInitialize(display, nil, nil) == EGL_FALSE) return false;
+    if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) goto failed;
+
+    GraphicsConfig *graphics = &native->graphics;
+    const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (graphics->samples > 0) {
+        eglChooseConfig(
+            display,
+            (EGLint[]){
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_RED_SIZE, 8,
+                EGL_GREEN_SIZE, 8,
+                EGL_BLUE_SIZE, 8,
+                EGL_ALPHA_SIZE, 8,
+                EGL_DEPTH_SIZE, 24,
+                EGL_SAMPLE_BUFFERS, 1,
+                EGL_SAMPLES, graphics->samples,
+                EGL_NONE,
+            },
+            &config, 1, &configCount);
+        if (configCount == 0) graphics->samples = 0;
+    }
+    if (configCount == 0) {
+        eglChooseConfig(
+            display,
+            (EGLint[]){
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_RED_SIZE, 8,
+                EGL_GREEN_SIZE, 8,
+                EGL_BLUE_SIZE, 8,
+                EGL_ALPHA_SIZE, 8,
+                EGL_DEPTH_SIZE, 24,
+                EGL_NONE,
+            },
+            &config, 1, &configCount);
+    }
+    if (configCount == 0) {
+        // Try again without needing pbuffer support. The surface type
+        // defaults to windows, which surfaceless displays never support, so
+        // it's cleared to match any config.
+        eglChooseConfig(
+            display,
+            (EGLint[]){EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE},
+            &config, 1, &configCount);
+    }
+    if (configCount == 0) goto failed;
+
+    EGLint contextAttributes[16];
+    int count = 0;
+    if (graphics->majorVersion > 0) {
+        contextAttributes[count++] = EGL_CONTEXT_MAJOR_VERSION;
+        contextAttributes[count++] = graphics->majorVersion;
+        contextAttributes[count++] = EGL_CONTEXT_MINOR_VERSION;
+        contextAttributes[count++] = graphics->minorVersion;
+    }
+    contextAttributes[count++] = EGL_CONTEXT_OPENGL_PROFILE_MASK;
+    contextAttributes[count++] = graphics->profile == GraphicsProfile_Core
+        ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT
+        : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT;
+    int noErrorAttribute = count;
+    if (graphics->noError && extensionSupported(extensions, "EGL_KHR_create_context_no_error")) {
+        contextAttributes[count++] = EGL_CONTEXT_OPENGL_NO_ERROR_KHR;
+        contextAttributes[count++] = EGL_TRUE;
+    }
+    contextAttributes[count++] = EGL_NONE;
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT && count - 1 > noErrorAttribute) {
+        contextAttributes[noErrorAttribute] = EGL_NONE;
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    }
+    if (context == EGL_NO_CONTEXT) goto failed;
+    if (contextAttributes[noErrorAttribute] == EGL_NONE) graphics->noError = false;
+
+    if (graphics->srgb && extensionSupported(extensions, "EGL_KHR_gl_colorspace") == false) {
+        graphics->srgb = false;
+    }
+    EGLint surfaceAttributes[] = {
+        EGL_WIDTH, window->width,
+        EGL_HEIGHT, window->height,
+        EGL_NONE, EGL_NONE,
+        EGL_NONE,
+    };
+    if (graphics->srgb) {
+        surfaceAttributes[4] = EGL_GL_COLORSPACE;
+        surfaceAttributes[5] = EGL_GL_COLORSPACE_SRGB;
+    }
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    if (surface == EGL_NO_SURFACE &&
+        extensionSupported(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") == false) {
+        eglDestroyContext(display, context);
+        goto failed;
+    }
+
+    if (eglMakeCurrent(display, surface, surface, context) == EGL_FALSE) {
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        eglDestroyContext(display, context);
+        goto failed;
+    }
+
+    native->eglDisplay = display;
+    native->eglContext = context;
+    native->eglSurface = surface;
+    native->swapInterval = 1;
+
+    // Both extensions have the same function, just under different names.
+    const char *displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensionSupported(displayExtensions, "EGL_KHR_swap_buffers_with_damage")) {
+        native->swapBuffersWithDamage =
+            (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    } else if (extensionSupported(displayExtensions, "EGL_EXT_swap_buffers_with_damage")) {
+        native->swapBuffersWithDamage =
+            (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+    }
+
+    glViewport(0, 0, window->width, window->height);
+    glEnable(GL_DEPTH_TEST);
+    if (graphics->srgb) glEnable(GL_FRAMEBUFFER_SRGB);
+    GLLoad(window);
+    return true;
+
+failed:
+    eglTerminate(display);
+    return false;
+}
+
+static const char *glxExtensions(WindowNative *native) {
+    return glXQueryExtensionsString(native->xDisplay, DefaultScreen(native->xDisplay));
+}
+
+static bool contextFailed;
+
+static int contextErrorHandler(Display *display, XErrorEvent *event) {
+    (void)display;
+    (void)event;
+    contextFailed = true;
+    return 0;
+}
+
+// `createContext` creates a context with the settings in `native->graphics`.
+// This returns nil if the driver can't create that kind of context.
+static GLXContext createContext(WindowNative *native, bool noError) {
+    GraphicsConfig graphics = native->graphics;
+    const char *extensions = glxExtensions(native);
+
+    PFNGLXCREATECONTEXTATTRIBSARBPROC createContextAttribs = nil;
+    if (extensionSupported(extensions, "GLX_ARB_create_context")) {
+        createContextAttribs = (PFNGLXCREATECONTEXTATTRIBSARBPROC)glXGetProcAddressARB(
+            (const GLubyte *)"glXCreateContextAttribsARB");
+    }
+    if (createContextAttribs == nil) {
+        // Without GLX_ARB_create_context we can't ask for a version or
+        // profile, only for whatever the driver gives us.
+        if (graphics.majorVersion > 0 || graphics.profile != GraphicsProfile_Compatibility) return nil;
+        return glXCreateNewContext(native->xDisplay, native->fbConfig, GLX_RGBA_TYPE, nil, True);
+    }
+
+    int attributes[16];
+    int count = 0;
+    if (graphics.majorVersion > 0) {
+        attributes[count++] = GLX_CONTEXT_MAJOR_VERSION_ARB;
+        attributes[count++] = graphics.majorVersion;
+        attributes[count++] = GLX_CONTEXT_MINOR_VERSION_ARB;
+        attributes[count++] = graphics.minorVersion;
+    }
+    if (extensionSupported(extensions, "GLX_ARB_create_context_profile")) {
+        attributes[count++] = GLX_CONTEXT_PROFILE_MASK_ARB;
+        attributes[count++] = graphics.profile == GraphicsProfile_Core
+            ? GLX_CONTEXT_CORE_PROFILE_BIT_ARB
+            : GLX_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB;
+    } else if (graphics.profile == GraphicsProfile_Core) {
+        return nil;
+    }
+    if (noError) {
+        attributes[count++] = GLX_CONTEXT_OPENGL_NO_ERROR_ARB;
+        attributes[count++] = True;
+    }
+    attributes[count++] = None;
+
+    // Asking for something the driver can't do raises an X error, which would
+    // otherwise end the program, so catch it instead.
+    contextFailed = false;
+    int (*previousHandler)(Display *, XErrorEvent *) = XSetErrorHandler(contextErrorHandler);
+    GLXContext glContext = createContextAttribs(native->xDisplay, native->fbConfig, nil, True, attributes);
+    XSync(native->xDisplay, False);
+    XSetErrorHandler(previousHandler);
+
+    if (contextFailed && glContext != nil) {
+        glXDestroyContext(native->xDisplay, glContext);
+        glContext = nil;
+    }
+    return glContext;
+}
+
 bool GraphicsInit(MinoWindow *window) {
-    GLXContext glContext = glXCreateContext(
-        window->native->xDisplay,
-        window->native->visualInfo,
-        nil,
-        GL_TRUE);
+    WindowNative *native = window->native;
+    if (native->headless) return graphicsInitHeadless(window);
+
+    GLXContext glContext = nil;
+    if (native->graphics.noError &&
+        extensionSupported(glxExtensions(native), "GLX_ARB_create_context_no_error")) {
+        glContext = createContext(native, true);
+    }
+    if (glContext == nil) {
+        native->graphics.noError = false;
+        glContext = createContext(native, false);
+    }
 
     if (glContext == nil) return false;
 
     glXMakeCurrent(
-        window->native->xDisplay,
-        window->native->xWindow,
+        native->xDisplay,
+        native->xWindow,
         glContext);
 
     glEnable(GL_DEPTH_TEST);
+    if (native->graphics.srgb) glEnable(GL_FRAMEBUFFER_SRGB);
 
     window->native->glContext = glContext;
+    window->native->swapInterval = 1;
+    if (extensionSupported(glxExtensions(native), "GLX_MESA_copy_sub_buffer")) {
+        native->copySubBuffer =
+            (PFNGLXCOPYSUBBUFFERMESAPROC)glXGetProcAddressARB((const GLubyte *)"glXCopySubBufferMESA");
+    }
+    GLLoad(window);
     return true;
 }
 
+void GraphicsAddDamage(MinoWindow *window, int x, int y, int width, int height) {
+    DamageRect rect = {x, y, width, height};
+    if (DamageClip(&rect, window->width, window->height) == false) return;
+    DamageAdd(&window->native->damage, rect.x, rect.y, rect.width, rect.height);
+}
+
+void *GraphicsGetProcAddress(MinoWindow *window, const char *name) {
+    if (window->native->headless) return (void *)eglGetProcAddress(name);
+    return (void *)glXGetProcAddressARB((const GLubyte *)name);
+}
+
 void GraphicsMakeCurrent(MinoWindow *window) {
-    glXMakeCurrent(
-        window->native->xDisplay,
-        window->native->xWindow,
-        window->native->glContext);
+    makeCurrent(window);
+}
+
+void GraphicsPresent(MinoWindow *window) {
+    window->native->presented = true;
+    window->stats.swapTime = swapBuffers(window);
+}
+
+int64 GraphicsSwapBuffers(MinoWindow *window) {
+    return swapBuffers(window);
+}
+
+bool GraphicsReleaseContext(MinoWindow *window) {
+    WindowNative *native = window->native;
+    if (native->headless) {
+        return eglMakeCurrent(native->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    if (native->threadSafe == false) return false;
+    return glXMakeCurrent(native->xDisplay, None, nil);
 }
 
 void GraphicsClose(MinoWindow *window) {
+    WindowNative *native = window->native;
+    if (native->headless) {
+        if (native->eglContext == nil) return;
+        UpscalerClose(window);
+        eglMakeCurrent(native->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (native->eglSurface != EGL_NO_SURFACE) eglDestroySurface(native->eglDisplay, native->eglSurface);
+        eglDestroyContext(native->eglDisplay, native->eglContext);
+        eglTerminate(native->eglDisplay);
+        native->eglContext = nil;
+        native->eglSurface = nil;
+        return;
+    }
     if (window->native->glContext == nil) return;
 
+    UpscalerClose(window);
     glXDestroyContext(
         window->native->xDisplay,
         window->native->glContext);
@@ -1088,4 +2506,286 @@ void GraphicsClose(MinoWindow *window) {
     window->native->glContext = nil;
 }
 
+bool GraphicsSetSwapInterval(MinoWindow *window, int interval) {
+    WindowNative *native = window->native;
+    bool exact = interval >= 0;
+
+    if (native->headless) {
+        if (native->eglContext == nil) return false;
+        // EGL doesn't have adaptive vsync.
+        if (interval < 0) interval = -interval;
+        if (eglSwapInterval(native->eglDisplay, interval) == EGL_FALSE) return false;
+        native->swapInterval = interval;
+        return exact;
+    }
+    if (native->glContext == nil) return false;
+
+    // GLX_EXT_swap_control is preferred since it's the only one that supports
+    // adaptive vsync (with GLX_EXT_swap_control_tear). Mesa drivers often only
+    // have GLX_MESA_swap_control, which can't tear.
+    const char *extensions = glxExtensions(native);
+    if (extensionSupported(extensions, "GLX_EXT_swap_control")) {
+        PFNGLXSWAPINTERVALEXTPROC swapInterval =
+            (PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddressARB((const GLubyte *)"glXSwapIntervalEXT");
+        if (swapInterval == nil) return false;
+        if (interval < 0 && extensionSupported(extensions, "GLX_EXT_swap_control_tear")) {
+            exact = true;
+        } else if (interval < 0) {
+            interval = -interval;
+        }
+        swapInterval(native->xDisplay, native->xWindow, interval);
+        native->swapInterval = interval;
+        return exact;
+    }
+    if (extensionSupported(extensions, "GLX_MESA_swap_control")) {
+        PFNGLXSWAPINTERVALMESAPROC swapInterval =
+            (PFNGLXSWAPINTERVALMESAPROC)glXGetProcAddressARB((const GLubyte *)"glXSwapIntervalMESA");
+        if (swapInterval == nil) return false;
+        if (interval < 0) interval = -interval;
+        if (swapInterval(interval) != 0) return false;
+        native->swapInterval = interval;
+        return exact;
+    }
+    return false;
+}
+
+int GraphicsGetSwapInterval(MinoWindow *window) {
+    WindowNative *native = window->native;
+    if (native->headless || native->glContext == nil) return native->swapInterval;
+
+    const char *extensions = glxExtensions(native);
+    if (extensionSupported(extensions, "GLX_EXT_swap_control")) {
+        unsigned int interval = 0, lateSwapsTear = 0;
+        glXQueryDrawable(native->xDisplay, native->xWindow, GLX_SWAP_INTERVAL_EXT, &interval);
+        if (extensionSupported(extensions, "GLX_EXT_swap_control_tear")) {
+            glXQueryDrawable(native->xDisplay, native->xWindow, GLX_LATE_SWAPS_TEAR_EXT, &lateSwapsTear);
+        }
+        return lateSwapsTear ? -(int)interval : (int)interval;
+    }
+    if (extensionSupported(extensions, "GLX_MESA_swap_control")) {
+        PFNGLXGETSWAPINTERVALMESAPROC getSwapInterval =
+            (PFNGLXGETSWAPINTERVALMESAPROC)glXGetProcAddressARB((const GLubyte *)"glXGetSwapIntervalMESA");
+        if (getSwapInterval) return getSwapInterval();
+    }
+    return native->swapInterval;
+}
+
+#endif  // MINO_NO_GL
+
+struct FramebufferNative {
+    MinoWindow *window;
+    // `image` is nil for headless windows, which have nowhere to show it.
+    XImage *image;
+    GC gc;
+    // `shared` is true when `image` is in memory shared with the X server
+    // through `segment`.
+    bool shared;
+    XShmSegmentInfo segment;
+};
+
+static bool shmFailed;
+
+static int shmErrorHandler(Display *display, XErrorEvent *event) {
+    (void)display;
+    (void)event;
+    shmFailed = true;
+    return 0;
+}
+
+// `createSharedImage` creates an image in memory shared with the X server.
+// This returns nil if the X server doesn't have MIT-SHM or can't attach to the
+// memory, which happens when it's running on another machine.
+static XImage *createSharedImage(WindowNative *native, int width, int height, XShmSegmentInfo *segment) {
+    Display *display = native->xDisplay;
+    if (XShmQueryExtension(display) == False) return nil;
+
+    XImage *image = XShmCreateImage(
+        display,
+        native->visualInfo->visual,
+        native->visualInfo->depth,
+        ZPixmap,
+        nil,
+        segment,
+        width, height);
+    if (image == nil) return nil;
+
+    segment->shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+    if (segment->shmid < 0) {
+        XDestroyImage(image);
+        return nil;
+    }
+    segment->shmaddr = image->data = shmat(segment->shmid, nil, 0);
+    segment->readOnly = False;
+
+    // Attaching fails with an X error rather than a return value, so errors
+    // are caught while the server handles the request.
+    shmFailed = segment->shmaddr == (char *)-1;
+    if (shmFailed == false) {
+        XSync(display, False);
+        int (*previousHandler)(Display *, XErrorEvent *) = XSetErrorHandler(shmErrorHandler);
+        XShmAttach(display, segment);
+        XSync(display, False);
+        XSetErrorHandler(previousHandler);
+    }
+
+    // Marking the segment for removal straight away means it's freed once
+    // both sides detach, even if the game crashes.
+    shmctl(segment->shmid, IPC_RMID, nil);
+    if (shmFailed) {
+        if (segment->shmaddr != (char *)-1) shmdt(segment->shmaddr);
+        image->data = nil;
+        XDestroyImage(image);
+        return nil;
+    }
+    return image;
+}
+
+bool FramebufferInit(Framebuffer *framebuffer, MinoWindow *window) {
+    WindowNative *native = window->native;
+    int width = window->width, height = window->height;
+    *framebuffer = (Framebuffer){
+        .width = width,
+        .height = height,
+        .screenWidth = width,
+        .screenHeight = height,
+        .scale = 1,
+    };
+
+    FramebufferNative *framebufferNative = allocate(FramebufferNative);
+    framebufferNative->window = window;
+
+    if (native->headless) {
+        framebuffer->stride = framebuffer->screenStride = width;
+        framebuffer->pixels = framebuffer->screen = allocateN(Pixel, width * height);
+        if (framebuffer->pixels == nil) {
+            free(framebufferNative);
+            return false;
+        }
+        framebuffer->native = framebufferNative;
+        DamageAdd(&framebuffer->damage, 0, 0, width, height);
+        return true;
+    }
+
+    // Pixels are written in the layout of `Pixel` so the window's visual has
+    // to store colors the same way.
+    XVisualInfo *visualInfo = native->visualInfo;
+    if (visualInfo->red_mask != 0xFF0000 || visualInfo->green_mask != 0xFF00 || visualInfo->blue_mask != 0xFF) {
+        println("Warning: the window's visual doesn't store colors as 8 bit RGB");
+        free(framebufferNative);
+        return false;
+    }
+
+    XImage *image = createSharedImage(native, width, height, &framebufferNative->segment);
+    framebufferNative->shared = image != nil;
+    if (image == nil) {
+        // Rows are padded to 4 pixels so every row starts 16 byte aligned.
+        int stride = (width + 3) & ~3;
+        Pixel *pixels = allocateN(Pixel, stride * height);
+        if (pixels == nil) {
+            free(framebufferNative);
+            return false;
+        }
+        image = XCreateImage(
+            native->xDisplay,
+            visualInfo->visual,
+            visualInfo->depth,
+            ZPixmap,
+            0,
+            (char *)pixels,
+            width, height,
+            32,
+            stride * sizeof(Pixel));
+        if (image == nil) {
+            free(pixels);
+            free(framebufferNative);
+            return false;
+        }
+    }
+    framebufferNative->image = image;
+    framebufferNative->gc = XCreateGC(native->xDisplay, native->xWindow, 0, nil);
+
+    framebuffer->pixels = framebuffer->screen = (Pixel *)image->data;
+    framebuffer->stride = framebuffer->screenStride = image->bytes_per_line / sizeof(Pixel);
+    framebuffer->native = framebufferNative;
+    if (image->bits_per_pixel != 32) {
+        println("Warning: the window's visual doesn't use 32 bits per pixel");
+        FramebufferClose(framebuffer);
+        return false;
+    }
+    DamageAdd(&framebuffer->damage, 0, 0, width, height);
+    return true;
+}
+
+void FramebufferPresent(Framebuffer *framebuffer) {
+    FramebufferNative *native = framebuffer->native;
+    Damage *damage = &framebuffer->damage;
+    if (native->image == nil) {
+        for (int i = 0; i < damage->count; i++) FramebufferUpscale(framebuffer, damage->rects[i]);
+        DamageClear(damage);
+        return;
+    }
+
+    WindowNative *window = native->window->native;
+    if (__atomic_exchange_n(&window->exposed, false, __ATOMIC_RELAXED)) {
+        DamageAdd(damage, 0, 0, framebuffer->screenWidth, framebuffer->screenHeight);
+    }
+    if (damage->count == 0) return;
+
+    for (int i = 0; i < damage->count; i++) {
+        DamageRect rect = damage->rects[i];
+        FramebufferUpscale(framebuffer, rect);
+        if (native->shared) {
+            XShmPutImage(
+                window->xDisplay,
+                window->xWindow,
+                native->gc,
+                native->image,
+                rect.x, rect.y, rect.x, rect.y,
+                rect.width, rect.height,
+                False);
+        } else {
+            XPutImage(
+                window->xDisplay,
+                window->xWindow,
+                native->gc,
+                native->image,
+                rect.x, rect.y, rect.x, rect.y,
+                rect.width, rect.height);
+        }
+    }
+    DamageClear(damage);
+
+    // The X server reads shared images when it handles the request, not when
+    // it's sent, so wait for that before the next frame is drawn.
+    if (native->shared) {
+        XSync(window->xDisplay, False);
+    } else {
+        XFlush(window->xDisplay);
+    }
+}
+
+void FramebufferClose(Framebuffer *framebuffer) {
+    FramebufferNative *native = framebuffer->native;
+    if (native == nil) return;
+    if (framebuffer->pixels != framebuffer->screen) free(framebuffer->pixels);
+
+    if (native->image) {
+        Display *display = native->window->native->xDisplay;
+        if (native->shared) {
+            XShmDetach(display, &native->segment);
+            XSync(display, False);
+            XDestroyImage(native->image);
+            shmdt(native->segment.shmaddr);
+        } else {
+            // This frees the pixels too.
+            XDestroyImage(native->image);
+        }
+        XFreeGC(display, native->gc);
+    } else {
+        free(framebuffer->screen);
+    }
+    free(native);
+    *framebuffer = (Framebuffer){0};
+}
+
 #endif
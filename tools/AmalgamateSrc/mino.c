@@ -4,12 +4,27 @@
 
 #include "../src/aff3.c"
 #include "../src/audio.c"
+#include "../src/broadphase.c"
 #include "../src/consts.c"
+#include "../src/damage.c"
+#include "../src/drawQueue.c"
+#include "../src/event.c"
+#include "../src/fastMath.c"
+#include "../src/framebuffer.c"
 #include "../src/gamepad.c"
+#include "../src/glLoader.c"
 #include "../src/list.c"
+#include "../src/pacer.c"
+#include "../src/profiler.c"
+#include "../src/record.c"
+#include "../src/render.c"
+#include "../src/snapshot.c"
+#include "../src/sprite.c"
 #include "../src/synth.c"
+#include "../src/texture.c"
+#include "../src/transformGraph.c"
+#include "../src/upscale.c"
 #include "../src/utils.c"
-#include "../src/vec2.c"
 #include "../src/window.c"
 
 #undef Window
@@ -1,13 +1,29 @@
 #include "aff3.h"
 #include "audio.h"
+#include "broadphase.h"
 #include "consts.h"
+#include "damage.h"
+#include "drawQueue.h"
+#include "event.h"
+#include "fastMath.h"
+#include "framebuffer.h"
 #include "gamepad.h"
+#include "glLoader.h"
 #include "graphics.h"
 #include "keyboard.h"
 #include "list.h"
+#include "mathInline.h"
 #include "mouse.h"
+#include "pacer.h"
+#include "profiler.h"
+#include "record.h"
+#include "render.h"
+#include "snapshot.h"
+#include "sprite.h"
 #include "synth.h"
+#include "transformGraph.h"
 #include "types.h"
+#include "upscale.h"
 #include "utils.h"
 #include "vec2.h"
 #include "window.h"
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef MathBench_H
+#define MathBench_H
+
+#include "aff3.h"
+#include "types.h"
+#include "vec2.h"
+
+// `Body` is a point mass moved by the benchmark's kernels.
+typedef struct Body {
+    Vec2 position;
+    Vec2 velocity;
+} Body;
+
+// Each kernel is compiled twice from `kernels.c`: once calling the normal
+// `Vec2` and `Aff3` functions and once with `MINO_INLINE_MATH`. They return a
+// checksum so both can be checked to give the same results.
+
+// `integrate*` moves every body by its velocity after adding gravity.
+float32 integrateOutOfLine(Body* bodies, int count, Vec2 gravity, float32 dt);
+float32 integrateInline(Body* bodies, int count, Vec2 gravity, float32 dt);
+
+// `springs*` works out the forces of springs joining each body to the next.
+float32 springsOutOfLine(const Body* bodies, Vec2* forces, int count, float32 rest, float32 stiffness);
+float32 springsInline(const Body* bodies, Vec2* forces, int count, float32 rest, float32 stiffness);
+
+// `transform*` places a quad at every body, rotated under a parent matrix,
+// and works out its corners.
+float32 transformOutOfLine(const Body* bodies, Vec2* corners, int count, Aff3 parent);
+float32 transformInline(const Body* bodies, Vec2* corners, int count, Aff3 parent);
+
+#endif  // MathBench_H
@@ -0,0 +1,49 @@
+#include "aff3.h"
+#include "bench.h"
+#include "types.h"
+#include "vec2.h"
+
+#if defined(MINO_INLINE_MATH)
+#define KERNEL(name) name##Inline
+#else
+#define KERNEL(name) name##OutOfLine
+#endif
+
+float32 KERNEL(integrate)(Body *bodies, int count, Vec2 gravity, float32 dt) {
+    Vec2 sum = {0, 0};
+    for (int i = 0; i < count; i++) {
+        Body *body = &bodies[i];
+        body->velocity = Vec2Add(body->velocity, Vec2Scale(gravity, dt));
+        body->position = Vec2Add(body->position, Vec2Scale(body->velocity, dt));
+        sum = Vec2Add(sum, body->position);
+    }
+    return sum.X + sum.Y;
+}
+
+float32 KERNEL(springs)(const Body *bodies, Vec2 *forces, int count, float32 rest, float32 stiffness) {
+    float32 sum = 0;
+    for (int i = 0; i + 1 < count; i++) {
+        Vec2 delta = Vec2Sub(bodies[i + 1].position, bodies[i].position);
+        float32 stretch = Vec2Length(delta) - rest;
+        Vec2 force = Vec2Scale(Vec2Normalize(delta), stretch * stiffness);
+        forces[i] = Vec2Add(forces[i], force);
+        forces[i + 1] = Vec2Sub(forces[i + 1], force);
+        sum += Vec2Dot(force, force);
+    }
+    return sum;
+}
+
+float32 KERNEL(transform)(const Body *bodies, Vec2 *corners, int count, Aff3 parent) {
+    const Vec2 quad[4] = {{0, 0}, {8, 0}, {8, 8}, {0, 8}};
+    float32 sum = 0;
+    for (int i = 0; i < count; i++) {
+        Vec2 position = bodies[i].position;
+        Aff3 local = Aff3Translate(Aff3Scale(Aff3Identity(), 2, 2), position.X, position.Y);
+        Aff3 world = Aff3Concat(local, parent);
+        for (int j = 0; j < 4; j++) {
+            corners[i * 4 + j] = Aff3TransformVec2(world, quad[j]);
+            sum += corners[i * 4 + j].X;
+        }
+    }
+    return sum;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+// `make bench` builds this to time the `Vec2` and `Aff3` functions inlined
+// from `mathInline.h` against the normal out-of-line ones.
+
+#define bodyCount 10000
+#define repeats 500
+
+typedef float32 (*Kernel)(Body *bodies, Vec2 *scratch, int count);
+
+static float32 integrateOut(Body *bodies, Vec2 *scratch, int count) {
+    (void)scratch;
+    return integrateOutOfLine(bodies, count, (Vec2){0, 9.8f}, 1 / 60.0f);
+}
+
+static float32 integrateIn(Body *bodies, Vec2 *scratch, int count) {
+    (void)scratch;
+    return integrateInline(bodies, count, (Vec2){0, 9.8f}, 1 / 60.0f);
+}
+
+static float32 springsOut(Body *bodies, Vec2 *scratch, int count) {
+    return springsOutOfLine(bodies, scratch, count, 1.5f, 0.1f);
+}
+
+static float32 springsIn(Body *bodies, Vec2 *scratch, int count) {
+    return springsInline(bodies, scratch, count, 1.5f, 0.1f);
+}
+
+static float32 transformOut(Body *bodies, Vec2 *scratch, int count) {
+    return transformOutOfLine(bodies, scratch, count, Aff3Rotate(Aff3Identity(), 30));
+}
+
+static float32 transformIn(Body *bodies, Vec2 *scratch, int count) {
+    return transformInline(bodies, scratch, count, Aff3Rotate(Aff3Identity(), 30));
+}
+
+static void resetBodies(Body *bodies, Vec2 *scratch) {
+    for (int i = 0; i < bodyCount; i++) {
+        bodies[i] = (Body){{(float32)(i % 100), (float32)(i / 100)}, {1, -1}};
+    }
+    memset(scratch, 0, sizeof(Vec2) * bodyCount * 4);
+}
+
+// `run` times `kernel` and returns nanoseconds per body. `checksum` is set to
+// the result of its last run.
+static float64 run(Kernel kernel, Body *bodies, Vec2 *scratch, float32 *checksum) {
+    resetBodies(bodies, scratch);
+    clock_t begin = clock();
+    for (int i = 0; i < repeats; i++) *checksum = kernel(bodies, scratch, bodyCount);
+    float64 seconds = (float64)(clock() - begin) / CLOCKS_PER_SEC;
+    return seconds * 1e9 / ((float64)repeats * bodyCount);
+}
+
+int main() {
+    Body *bodies = malloc(sizeof(Body) * bodyCount);
+    Vec2 *scratch = malloc(sizeof(Vec2) * bodyCount * 4);
+    if (bodies == nil || scratch == nil) return 1;
+
+    struct {
+        const char *name;
+        Kernel outOfLine, inlined;
+    } kernels[] = {
+        {"integrate", integrateOut, integrateIn},
+        {"springs", springsOut, springsIn},
+        {"transform", transformOut, transformIn},
+    };
+
+    bool same = true;
+    printf("%-10s %12s %12s %8s\n", "kernel", "out-of-line", "inline", "speedup");
+    for (int i = 0; i < (int)(sizeof(kernels) / sizeof(kernels[0])); i++) {
+        float32 outChecksum, inChecksum;
+        float64 outTime = run(kernels[i].outOfLine, bodies, scratch, &outChecksum);
+        float64 inTime = run(kernels[i].inlined, bodies, scratch, &inChecksum);
+        printf("%-10s %9.2f ns %9.2f ns %7.2fx\n", kernels[i].name, outTime, inTime, outTime / inTime);
+        if (outChecksum != inChecksum) {
+            printf("%-10s gave different results: %f and %f\n", kernels[i].name, outChecksum, inChecksum);
+            same = false;
+        }
+    }
+
+    free(bodies);
+    free(scratch);
+    return same ? 0 : 1;
+}